@@ -1,9 +1,12 @@
+#include "ipv4_datagram.hh"
 #include "tcp_connection.hh"
+#include "tcp_over_ip.hh"
 
 #include <chrono>
 #include <cstdlib>
 #include <iomanip>
 #include <iostream>
+#include <new>
 #include <string>
 
 using namespace std;
@@ -11,9 +14,63 @@ using namespace std::chrono;
 
 constexpr size_t len = 100 * 1024 * 1024;
 
-void move_segments(TCPConnection &x, TCPConnection &y, vector<TCPSegment> &segments, const bool reorder) {
+//! heap allocations made so far, counted by the replacement operator new below
+static size_t allocations = 0;
+
+void *operator new(size_t size) {
+    ++allocations;
+    if (void *ptr = malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+
+//! One direction of an IPv4 path: each segment is wrapped and serialized by one adapter, copied into a datagram
+//! of its own as a TUN device would, and parsed and unwrapped by the other
+struct IPv4Link {
+    TCPOverIPv4Adapter &from;
+    TCPOverIPv4Adapter &to;
+
+    TCPSegment carry(TCPSegment &&seg) {
+        InternetDatagram datagram;
+        if (datagram.parse(Buffer{from.wrap_tcp_in_ip(move(seg)).serialize().concatenate()}) != ParseResult::NoError) {
+            throw runtime_error("IPv4 datagram failed to parse");
+        }
+        auto unwrapped = to.unwrap_tcp_in_ip(datagram);
+        if (not unwrapped.has_value()) {
+            throw runtime_error("TCP segment failed to unwrap");
+        }
+        return move(unwrapped.value());
+    }
+};
+
+//! Loses every `drop_every`-th segment carrying payload, counted over one transfer
+struct SegmentDropper {
+    size_t drop_every;
+    size_t payload_segments = 0;
+
+    bool drop(const TCPSegment &seg) {
+        return seg.payload().size() > 0 and ++payload_segments % drop_every == 0;
+    }
+};
+
+//! \param dropper if set, decides which segments are lost on the way
+//! \param link if set, the IPv4 path the segments take
+void move_segments(TCPConnection &x,
+                   TCPConnection &y,
+                   vector<TCPSegment> &segments,
+                   const bool reorder,
+                   SegmentDropper *dropper = nullptr,
+                   IPv4Link *link = nullptr) {
     while (not x.segments_out().empty()) {
-        segments.emplace_back(move(x.segments_out().front()));
+        if (dropper and dropper->drop(x.segments_out().front())) {
+            x.segments_out().pop();
+            continue;
+        }
+        segments.emplace_back(link ? link->carry(move(x.segments_out().front())) : move(x.segments_out().front()));
         x.segments_out().pop();
     }
     if (reorder) {
@@ -28,9 +85,17 @@ void move_segments(TCPConnection &x, TCPConnection &y, vector<TCPSegment> &segme
     segments.clear();
 }
 
-void main_loop(const bool reorder) {
-    TCPConfig config;
+//! \param over_ipv4 whether segments are carried in serialized IPv4 datagrams, or handed over as they are
+void main_loop(const bool reorder, const TCPConfig &config, const string &variant, const bool over_ipv4 = false) {
     TCPConnection x{config}, y{config};
+    const bool zero_copy = config.send_stream_mode == ByteStream::Mode::Chunked;
+
+    TCPOverIPv4Adapter x_adapter, y_adapter;
+    x_adapter.config_mut().source = {"10.0.0.1", 1234};
+    x_adapter.config_mut().destination = {"10.0.0.2", 5678};
+    y_adapter.config_mut().source = x_adapter.config().destination;
+    y_adapter.config_mut().destination = x_adapter.config().source;
+    IPv4Link x_to_y{x_adapter, y_adapter}, y_to_x{y_adapter, x_adapter};
 
     string string_to_send(len, 'x');
     for (auto &ch : string_to_send) {
@@ -47,12 +112,14 @@ void main_loop(const bool reorder) {
     string_received.reserve(len);
 
     const auto first_time = high_resolution_clock::now();
+    const size_t first_allocations = allocations;
 
     auto loop = [&] {
         // write input into x
         while (bytes_to_send.size() and x.remaining_outbound_capacity()) {
             const auto want = min(x.remaining_outbound_capacity(), bytes_to_send.size());
-            const auto written = x.write(string(bytes_to_send.str().substr(0, want)));
+            const auto written = zero_copy ? x.write(bytes_to_send.substr(0, want))
+                                           : x.write(string(bytes_to_send.str().substr(0, want)));
             if (want != written) {
                 throw runtime_error("want = " + to_string(want) + ", written = " + to_string(written));
             }
@@ -66,8 +133,8 @@ void main_loop(const bool reorder) {
 
         // exchange segments between x and y but in reverse order
         vector<TCPSegment> segments;
-        move_segments(x, y, segments, reorder);
-        move_segments(y, x, segments, false);
+        move_segments(x, y, segments, reorder, nullptr, over_ipv4 ? &x_to_y : nullptr);
+        move_segments(y, x, segments, false, nullptr, over_ipv4 ? &y_to_x : nullptr);
 
         // read output from y
         const auto available_output = y.inbound_stream().buffer_size();
@@ -89,14 +156,142 @@ void main_loop(const bool reorder) {
     }
 
     const auto final_time = high_resolution_clock::now();
+    const size_t allocations_per_mb = (allocations - first_allocations) / (len >> 20);
 
     const auto duration = duration_cast<nanoseconds>(final_time - first_time).count();
 
     const auto gigabits_per_second = len * 8.0 / double(duration);
 
     cout << fixed << setprecision(2);
-    cout << "CPU-limited throughput" << (reorder ? " with reordering: " : "                : ") << gigabits_per_second
-         << " Gbit/s\n";
+    cout << "CPU-limited throughput" << variant << gigabits_per_second << " Gbit/s, " << allocations_per_mb
+         << " allocations per MB\n";
+
+    while (x.active() or y.active()) {
+        loop();
+    }
+}
+
+//! Transfer `size` bytes over a path losing one data segment in `drop_every`, one millisecond per round trip,
+//! and report how long the transfer took in simulated time: without fast retransmit each loss costs a full RTO
+void lossy_loop(const size_t size, const size_t drop_every, const TCPConfig &config, const string &variant) {
+    TCPConnection x{config}, y{config};
+
+    string string_to_send(size, 'x');
+    for (auto &ch : string_to_send) {
+        ch = rand();
+    }
+
+    Buffer bytes_to_send{string(string_to_send)};
+    x.connect();
+    y.end_input_stream();
+
+    bool x_closed = false;
+
+    string string_received;
+    string_received.reserve(size);
+
+    size_t elapsed_ms = 0;
+    SegmentDropper dropper{drop_every};
+
+    auto loop = [&] {
+        while (bytes_to_send.size() and x.remaining_outbound_capacity()) {
+            const auto want = min(x.remaining_outbound_capacity(), bytes_to_send.size());
+            bytes_to_send.remove_prefix(x.write(string(bytes_to_send.str().substr(0, want))));
+        }
+
+        if (bytes_to_send.size() == 0 and not x_closed) {
+            x.end_input_stream();
+            x_closed = true;
+        }
+
+        // exchange segments between x and y, losing some of x's on the way
+        vector<TCPSegment> segments;
+        move_segments(x, y, segments, false, &dropper);
+        move_segments(y, x, segments, false);
+
+        const auto available_output = y.inbound_stream().buffer_size();
+        if (available_output > 0) {
+            string_received.append(y.inbound_stream().read(available_output));
+        }
+
+        // one round trip passes
+        x.tick(1);
+        y.tick(1);
+        ++elapsed_ms;
+
+        if (y.inbound_stream().error()) {
+            throw runtime_error("connection reset after " + to_string(elapsed_ms) + " ms");
+        }
+    };
+
+    while (not y.inbound_stream().eof()) {
+        loop();
+    }
+
+    if (string_received != string_to_send) {
+        throw runtime_error("strings sent vs. received don't match");
+    }
+
+    cout << "Simulated transfer time" << variant << elapsed_ms << " ms\n";
+
+    while (x.active() or y.active()) {
+        loop();
+    }
+}
+
+//! Write `size` bytes in `write_size`-byte writes, `writes_per_round_trip` of them per round trip, and report how
+//! many data segments carried them
+void small_writes_loop(const size_t size,
+                       const size_t write_size,
+                       const size_t writes_per_round_trip,
+                       const TCPConfig &config,
+                       const string &variant) {
+    TCPConnection x{config}, y{config};
+    x.connect();
+    y.end_input_stream();
+
+    bool x_closed = false;
+    size_t written = 0;
+    size_t data_segments = 0;
+    size_t received = 0;
+    vector<TCPSegment> segments;
+
+    auto loop = [&] {
+        for (size_t i = 0; i < writes_per_round_trip and written < size; ++i) {
+            written += x.write(string(min(write_size, size - written), 'x'));
+        }
+        if (written == size and not x_closed) {
+            x.end_input_stream();
+            x_closed = true;
+        }
+
+        segments.clear();
+        while (not x.segments_out().empty()) {
+            data_segments += x.segments_out().front().payload().size() > 0;
+            segments.emplace_back(move(x.segments_out().front()));
+            x.segments_out().pop();
+        }
+        for (auto &seg : segments) {
+            y.segment_received(move(seg));
+        }
+        segments.clear();
+        move_segments(y, x, segments, false);
+
+        received += y.inbound_stream().read(y.inbound_stream().buffer_size()).size();
+
+        x.tick(1);
+        y.tick(1);
+    };
+
+    while (not y.inbound_stream().eof()) {
+        loop();
+    }
+
+    if (received != size) {
+        throw runtime_error("bytes sent vs. received don't match");
+    }
+
+    cout << "Data segments for " << size / write_size << " writes" << variant << data_segments << "\n";
 
     while (x.active() or y.active()) {
         loop();
@@ -105,8 +300,47 @@ void main_loop(const bool reorder) {
 
 int main() {
     try {
-        main_loop(false);
-        main_loop(true);
+        TCPConfig config;
+        main_loop(false, config, "                      : ");
+        main_loop(true, config, " with reordering     : ");
+        main_loop(false, config, " over IPv4           : ", true);
+
+        config.reassembler_backend = StreamReassembler::Backend::Bitmap;
+        main_loop(true, config, " with reordering, bmp: ");
+
+        config = TCPConfig{};
+        config.send_stream_mode = ByteStream::Mode::Chunked;
+        main_loop(false, config, " with zero-copy      : ");
+
+        config = TCPConfig{};
+        config.delayed_ack = true;
+        main_loop(false, config, " with delayed ACKs   : ");
+
+        config = TCPConfig{};
+        config.mss = 16000;
+        main_loop(false, config, " with 16 KB MSS      : ");
+
+        config = TCPConfig{};
+        config.header_prediction = false;
+        main_loop(false, config, " without header pred.: ");
+
+        // 4 MB with 1% and 5% of data segments lost
+        for (const size_t drop_every : {100, 20}) {
+            const string loss = " with " + to_string(100 / drop_every) + "% loss, ";
+            config = TCPConfig{};
+            config.sack = false;
+            lossy_loop(4 * 1024 * 1024, drop_every, config, loss + "RTO only             : ");
+            config.fast_retransmit = true;
+            lossy_loop(4 * 1024 * 1024, drop_every, config, loss + "fast retransmit      : ");
+            config.sack = true;
+            lossy_loop(4 * 1024 * 1024, drop_every, config, loss + "fast retransmit, SACK: ");
+        }
+
+        // 100 KB in 100-byte writes, 20 per round trip
+        config = TCPConfig{};
+        small_writes_loop(100 * 1000, 100, 20, config, " with no-delay       : ");
+        config.no_delay = false;
+        small_writes_loop(100 * 1000, 100, 20, config, " with Nagle          : ");
     } catch (const exception &e) {
         cerr << e.what() << "\n";
         return EXIT_FAILURE;
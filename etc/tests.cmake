@@ -21,6 +21,18 @@ add_test(NAME t_send_window          COMMAND send_window)
 add_test(NAME t_send_ack             COMMAND send_ack)
 add_test(NAME t_send_close           COMMAND send_close)
 add_test(NAME t_send_extra           COMMAND send_extra)
+add_test(NAME t_send_congestion      COMMAND send_congestion)
+add_test(NAME t_send_rto             COMMAND send_rto)
+add_test(NAME t_send_recovery        COMMAND send_recovery)
+add_test(NAME t_send_sack            COMMAND send_sack)
+add_test(NAME t_send_scoreboard      COMMAND send_scoreboard)
+add_test(NAME t_send_pacing          COMMAND send_pacing)
+add_test(NAME t_send_coalesce        COMMAND send_coalesce)
+add_test(NAME t_send_mtu_probe       COMMAND send_mtu_probe)
+add_test(NAME t_send_rack            COMMAND send_rack)
+add_test(NAME t_send_persist         COMMAND send_persist)
+add_test(NAME t_send_prr             COMMAND send_prr)
+add_test(NAME t_send_bbr             COMMAND send_bbr)
 
 add_test(NAME t_strm_reassem_single      COMMAND fsm_stream_reassembler_single)
 add_test(NAME t_strm_reassem_seq         COMMAND fsm_stream_reassembler_seq)
@@ -30,12 +42,16 @@ add_test(NAME t_strm_reassem_many        COMMAND fsm_stream_reassembler_many)
 add_test(NAME t_strm_reassem_overlapping COMMAND fsm_stream_reassembler_overlapping)
 add_test(NAME t_strm_reassem_win         COMMAND fsm_stream_reassembler_win)
 add_test(NAME t_strm_reassem_cap         COMMAND fsm_stream_reassembler_cap)
+add_test(NAME t_strm_reassem_bitmap      COMMAND fsm_stream_reassembler_bitmap)
+add_test(NAME t_strm_reassem_buffer      COMMAND fsm_stream_reassembler_buffer)
+add_test(NAME t_strm_reassem_fast        COMMAND fsm_stream_reassembler_fast)
 
 add_test(NAME t_byte_stream_construction COMMAND byte_stream_construction)
 add_test(NAME t_byte_stream_one_write    COMMAND byte_stream_one_write)
 add_test(NAME t_byte_stream_two_writes   COMMAND byte_stream_two_writes)
 add_test(NAME t_byte_stream_capacity     COMMAND byte_stream_capacity)
 add_test(NAME t_byte_stream_many_writes  COMMAND byte_stream_many_writes)
+add_test(NAME t_byte_stream_chunked      COMMAND byte_stream_chunked)
 
 add_test(NAME t_webget               COMMAND "${PROJECT_SOURCE_DIR}/tests/webget_t.sh")
 
@@ -45,6 +61,7 @@ add_test(NAME router_test    COMMAND network_simulator)
 
 add_test(NAME t_tcp_parser           COMMAND tcp_parser "${PROJECT_SOURCE_DIR}/tests/ipv4_parser.data")
 add_test(NAME t_ipv4_parser          COMMAND ipv4_parser "${PROJECT_SOURCE_DIR}/tests/ipv4_parser.data")
+add_test(NAME t_tcp_options          COMMAND tcp_options)
 add_test(NAME t_active_close         COMMAND fsm_active_close)
 add_test(NAME t_passive_close        COMMAND fsm_passive_close)
 add_test(NAME ec_ack_rst             COMMAND fsm_ack_rst)
@@ -56,6 +73,14 @@ add_test(NAME t_connect              COMMAND fsm_connect_relaxed)
 add_test(NAME ec_listen              COMMAND fsm_listen)
 add_test(NAME t_listen               COMMAND fsm_listen_relaxed)
 add_test(NAME t_winsize              COMMAND fsm_winsize)
+add_test(NAME t_winscale             COMMAND fsm_winscale)
+add_test(NAME t_sack                 COMMAND fsm_sack)
+add_test(NAME t_delayed_ack          COMMAND fsm_delayed_ack)
+add_test(NAME t_mss                  COMMAND fsm_mss)
+add_test(NAME t_fsm_coalesce         COMMAND fsm_coalesce)
+add_test(NAME t_timestamps           COMMAND fsm_timestamps)
+add_test(NAME t_ecn                  COMMAND fsm_ecn)
+add_test(NAME t_header_prediction    COMMAND fsm_header_prediction)
 add_test(NAME ec_retx                COMMAND fsm_retx)
 add_test(NAME t_retx                 COMMAND fsm_retx_relaxed)
 add_test(NAME t_retx_win             COMMAND fsm_retx_win)
@@ -1,53 +1,111 @@
 #include "byte_stream.hh"
 
+#include <algorithm>
+#include <cstring>
+
 using namespace std;
 
-ByteStream::ByteStream(const size_t _capacity) : buffer(vector<char>(_capacity)), capacity(_capacity) {}
+ByteStream::ByteStream(const size_t _capacity, const Mode _mode)
+    : mode(_mode), buffer(vector<char>(_mode == Mode::Ring ? _capacity : 0)), capacity(_capacity) {}
+
+//! \details The bytes are copied into the ring in at most two contiguous spans:
+//! from the write pointer up to the physical end of the ring, then from the front.
+void ByteStream::ring_write(string_view data) {
+    const size_t first_span = min(data.size(), capacity - currWrite);
+    memcpy(buffer.data() + currWrite, data.data(), first_span);
+    memcpy(buffer.data(), data.data() + first_span, data.size() - first_span);
+    currWrite = (currWrite + data.size()) % capacity;
+}
 
 size_t ByteStream::write(const string &data) {
-    size_t count = 0;
-    for (size_t i = 0; i < data.size() && remaining_capacity(); ++i, ++count, ++totalWritten) {
-        buffer[currWrite] = data[i];
-        currWrite = (currWrite + 1) % capacity;
+    const size_t count = min(data.size(), remaining_capacity());
+    if (count == 0) {
+        return 0;
+    }
+    if (mode == Mode::Ring) {
+        ring_write({data.data(), count});
+    } else {
+        chunks.emplace_back(data.substr(0, count));
     }
+    totalWritten += count;
+    return count;
+}
+
+//! \param[in] data is the Buffer to append; in Mode::Chunked the stream shares its storage
+size_t ByteStream::write(Buffer data) {
+    const size_t count = min(data.size(), remaining_capacity());
+    if (count == 0) {
+        return 0;
+    }
+    if (mode == Mode::Ring) {
+        ring_write(data.str().substr(0, count));
+    } else {
+        chunks.push_back(count == data.size() ? move(data) : data.substr(0, count));
+    }
+    totalWritten += count;
     return count;
 }
 
 //! \param[in] len bytes will be copied from the output side of the buffer
 string ByteStream::peek_output(const size_t len) const {
+    const size_t toPeek = min(len, buffer_size());
     string peek;
-    size_t walker = currRead;
-    size_t toPeek = min(len, buffer_size());
-    while (toPeek--) {
-        peek += buffer[walker];
-        walker = (walker + 1) % capacity;
+    peek.reserve(toPeek);
+    if (mode == Mode::Ring) {
+        const size_t first_span = min(toPeek, capacity - currRead);
+        peek.append(buffer.data() + currRead, first_span);
+        peek.append(buffer.data(), toPeek - first_span);
+    } else {
+        for (auto it = chunks.begin(); peek.size() < toPeek; ++it) {
+            peek.append(it->str().substr(0, toPeek - peek.size()));
+        }
     }
     return peek;
 }
 
 //! \param[in] len bytes will be removed from the output side of the buffer
 void ByteStream::pop_output(const size_t len) {
-    size_t toPop = min(len, buffer_size());
-    while (toPop--) {
-        currRead = (currRead + 1) % capacity;
-        ++totalRead;
+    const size_t toPop = min(len, buffer_size());
+    if (toPop == 0) {
+        return;
+    }
+    if (mode == Mode::Ring) {
+        currRead = (currRead + toPop) % capacity;
+    } else {
+        size_t remaining = toPop;
+        while (remaining > 0) {
+            if (remaining < chunks.front().size()) {
+                chunks.front().remove_prefix(remaining);
+                break;
+            }
+            remaining -= chunks.front().size();
+            chunks.pop_front();
+        }
     }
+    totalRead += toPop;
 }
 
 //! Read (i.e., copy and then pop) the next "len" bytes of the stream
 //! \param[in] len bytes will be popped and returned
 //! \returns a string
 std::string ByteStream::read(const size_t len) {
-    string read;
-    size_t toRead = min(len, buffer_size());
-    while (toRead--) {
-        read += buffer[currRead];
-        currRead = (currRead + 1) % capacity;
-        ++totalRead;
-    }
+    string read = peek_output(len);
+    pop_output(read.size());
     return read;
 }
 
+//! \param[in] len bytes will be popped and returned
+//! \returns a Buffer that shares the written storage when the bytes lie within one written chunk
+Buffer ByteStream::read_buffer(const size_t len) {
+    const size_t toRead = min(len, buffer_size());
+    if (mode == Mode::Chunked && toRead > 0 && chunks.front().size() >= toRead) {
+        Buffer slice = chunks.front().substr(0, toRead);
+        pop_output(toRead);
+        return slice;
+    }
+    return Buffer{read(toRead)};
+}
+
 void ByteStream::end_input() { isInputEnded = true; }
 
 bool ByteStream::input_ended() const { return isInputEnded; }
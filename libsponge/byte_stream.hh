@@ -1,6 +1,9 @@
 #ifndef SPONGE_LIBSPONGE_BYTE_STREAM_HH
 #define SPONGE_LIBSPONGE_BYTE_STREAM_HH
 
+#include "buffer.hh"
+
+#include <deque>
 #include <string>
 #include <vector>
 //! \brief An in-order byte stream.
@@ -9,6 +12,13 @@
 //! side.  The byte stream is finite: the writer can end the input,
 //! and then no more bytes can be written.
 class ByteStream {
+  public:
+    //! How the stream stores the bytes it holds
+    enum class Mode {
+        Ring,    //!< Copy bytes into a fixed ring buffer
+        Chunked  //!< Keep the written Buffers themselves and hand out slices of them (no copies)
+    };
+
   private:
     // Your code here -- add private members as necessary.
 
@@ -16,7 +26,9 @@ class ByteStream {
     // all, but if any of your tests are taking longer than a second,
     // that's a sign that you probably want to keep exploring
     // different approaches.
-    std::vector<char> buffer;
+    Mode mode;
+    std::vector<char> buffer;  // ring storage, data is moved in and out with at most two memcpy spans per call
+    std::deque<Buffer> chunks{};  // chunked storage, the unread parts of the written Buffers in order
     size_t capacity;
     size_t currRead{0};   // the current location of pointer to next read operation
     size_t currWrite{0};  // the current location of pointer to next write operation
@@ -26,9 +38,12 @@ class ByteStream {
     bool isInputEnded{false};  // the writer side flag
     bool isAllRead{false};     // the reader side flag
 
+    //! Copy `data` (which must fit) into the ring buffer
+    void ring_write(std::string_view data);
+
   public:
     //! Construct a stream with room for `capacity` bytes.
-    ByteStream(const size_t capacity);
+    ByteStream(const size_t capacity, const Mode mode = Mode::Ring);
 
     //! \name "Input" interface for the writer
     //!@{
@@ -38,6 +53,11 @@ class ByteStream {
     //! \returns the number of bytes accepted into the stream
     size_t write(const std::string &data);
 
+    //! Write a Buffer into the stream. In Mode::Chunked the stream keeps (a slice of)
+    //! the Buffer itself instead of copying its bytes.
+    //! \returns the number of bytes accepted into the stream
+    size_t write(Buffer data);
+
     //! \returns the number of additional bytes that the stream has space for
     size_t remaining_capacity() const;
 
@@ -62,6 +82,10 @@ class ByteStream {
     //! \returns a string
     std::string read(const size_t len);
 
+    //! Read the next "len" bytes of the stream as a Buffer.
+    //! In Mode::Chunked, bytes that lie within one written Buffer are returned as a slice sharing its storage.
+    Buffer read_buffer(const size_t len);
+
     //! \returns `true` if the stream input has ended
     bool input_ended() const;
 
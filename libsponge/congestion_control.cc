@@ -0,0 +1,301 @@
+#include "congestion_control.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+void CongestionControl::slow_start(const uint64_t bytes_acked) { _cwnd += min(bytes_acked, _mss); }
+
+void CongestionControl::enter_recovery(const uint64_t bytes_in_flight, const uint64_t now, const bool sack) {
+    on_loss(bytes_in_flight, now);
+    _cwnd = sack ? _ssthresh : _ssthresh + 3 * _mss;
+}
+
+//! \details If at least one MSS was acknowledged, one MSS is added back so that a segment beyond the
+//! retransmission can be sent (RFC 6582, section 3.2, step 5).
+void CongestionControl::on_partial_ack(const uint64_t bytes_acked) {
+    _cwnd -= min(_cwnd, bytes_acked);
+    if (bytes_acked >= _mss) {
+        _cwnd += _mss;
+    }
+    _cwnd = max(_cwnd, _mss);
+}
+
+//! \details cwnd = min(ssthresh, max(FlightSize, MSS) + MSS) (RFC 6582, section 3.2, step 3, option 1)
+void CongestionControl::exit_recovery(const uint64_t bytes_in_flight) {
+    _cwnd = min(_ssthresh, max(bytes_in_flight, _mss) + _mss);
+}
+
+void CongestionControl::on_ecn_echo(const uint64_t bytes_in_flight, const uint64_t now) {
+    on_loss(bytes_in_flight, now);
+    _cwnd = _ssthresh;
+}
+
+unique_ptr<CongestionControl> CongestionControl::make(const Algorithm algorithm, const size_t mss) {
+    switch (algorithm) {
+        case Algorithm::NewReno:
+            return make_unique<NewReno>(mss);
+        case Algorithm::Cubic:
+            return make_unique<Cubic>(mss);
+        case Algorithm::BBR:
+            return make_unique<BBR>(mss);
+        case Algorithm::DCTCP:
+            return make_unique<DCTCP>(mss);
+        case Algorithm::None:
+            break;
+    }
+    return nullptr;
+}
+
+//! \details In slow start cwnd grows by one MSS per acknowledgment; in congestion avoidance it
+//! grows by one MSS each time a full cwnd of bytes has been acknowledged.
+void NewReno::on_ack(const AckEvent &ack) {
+    if (in_slow_start()) {
+        slow_start(ack.bytes_acked);
+        return;
+    }
+    _bytes_acked_in_avoidance += ack.bytes_acked;
+    if (_bytes_acked_in_avoidance >= _cwnd) {
+        _bytes_acked_in_avoidance -= _cwnd;
+        _cwnd += _mss;
+    }
+}
+
+//! \details cwnd drops to the loss window of one MSS (RFC 5681, section 3.1)
+void NewReno::on_timeout(const uint64_t bytes_in_flight, const uint64_t now) {
+    on_loss(bytes_in_flight, now);
+    _cwnd = _mss;
+}
+
+//! \details ssthresh drops to half the flight size (RFC 5681, eq. 4)
+void NewReno::on_loss(const uint64_t bytes_in_flight, const uint64_t) {
+    _ssthresh = max(bytes_in_flight / 2, 2 * _mss);
+    _bytes_acked_in_avoidance = 0;
+}
+
+//! \details The sender knows nothing of sequence numbers here, so a window ends once as many bytes as cwnd held
+//! at its start have been acknowledged, rather than at the SND.NXT of its start (RFC 8257, section 3.3):
+//! about a round trip either way.
+void DCTCP::on_ack(const AckEvent &ack) {
+    _bytes_acked += ack.bytes_acked;
+    _bytes_marked += ack.ece ? ack.bytes_acked : 0;
+    if (_bytes_acked >= _window_size) {
+        _alpha = (1 - G) * _alpha + G * double(_bytes_marked) / double(_bytes_acked);
+        _bytes_acked = 0;
+        _bytes_marked = 0;
+        _window_size = _cwnd;
+    }
+    NewReno::on_ack(ack);
+}
+
+void DCTCP::on_ecn_echo(const uint64_t, const uint64_t) {
+    _cwnd = max(static_cast<uint64_t>(double(_cwnd) * (1 - _alpha / 2)), 2 * _mss);
+    _ssthresh = _cwnd;
+}
+
+void Cubic::begin_epoch(const uint64_t now) {
+    const double cwnd_segments = double(_cwnd) / double(_mss);
+    _epoch = now;
+    _w_est = cwnd_segments;
+    if (cwnd_segments < _w_max) {
+        _k = cbrt((_w_max - cwnd_segments) / C);
+    } else {
+        _k = 0;
+        _w_max = cwnd_segments;
+    }
+}
+
+void Cubic::on_loss(const uint64_t, const uint64_t) {
+    const double cwnd_segments = double(_cwnd) / double(_mss);
+    // fast convergence: release bandwidth sooner when the window keeps shrinking
+    _w_max = cwnd_segments < _w_max ? cwnd_segments * (1 + BETA) / 2 : cwnd_segments;
+    _ssthresh = max(static_cast<uint64_t>(double(_cwnd) * BETA), 2 * _mss);
+    _epoch.reset();
+    _cwnd_fraction = 0;
+}
+
+//! \details In congestion avoidance cwnd moves towards W_cubic(t), or towards the Reno-friendly
+//! estimate W_est if that is larger, by (target - cwnd) / cwnd segments per segment acknowledged.
+void Cubic::on_ack(const AckEvent &ack) {
+    if (in_slow_start()) {
+        slow_start(ack.bytes_acked);
+        return;
+    }
+    if (not _epoch.has_value()) {
+        begin_epoch(ack.now);
+    }
+
+    const double cwnd_segments = double(_cwnd) / double(_mss);
+    const double segments_acked = double(ack.bytes_acked) / double(_mss);
+    const double t = double(ack.now - _epoch.value()) / 1000;
+
+    _w_est += 3 * (1 - BETA) / (1 + BETA) * segments_acked / cwnd_segments;
+    double target = max(C * pow(t - _k, 3) + _w_max, _w_est);
+    target = min(target, 1.5 * cwnd_segments);  // never more than 50% growth per RTT
+    if (target <= cwnd_segments) {
+        return;
+    }
+
+    _cwnd_fraction += (target - cwnd_segments) / cwnd_segments * segments_acked * double(_mss);
+    const auto growth = static_cast<uint64_t>(_cwnd_fraction);
+    _cwnd += growth;
+    _cwnd_fraction -= double(growth);
+}
+
+void Cubic::on_timeout(const uint64_t bytes_in_flight, const uint64_t now) {
+    on_loss(bytes_in_flight, now);
+    _cwnd = _mss;
+}
+
+//! \details RTprop is taken as at least a millisecond, the resolution of the sender's clock.
+uint64_t BBR::bdp(const double gain) const {
+    if (!_rtprop.has_value()) {
+        return 0;
+    }
+    return static_cast<uint64_t>(gain * double(btlbw()) * double(max<uint64_t>(*_rtprop, 1)) / 1000);
+}
+
+void BBR::on_timeout(const uint64_t, const uint64_t) {
+    _prior_cwnd = _cwnd;
+    _cwnd = _mss;
+}
+
+void BBR::enter_recovery(const uint64_t bytes_in_flight, const uint64_t, const bool) {
+    _prior_cwnd = _cwnd;
+    _cwnd = max(bytes_in_flight, min_cwnd());
+}
+
+void BBR::exit_recovery(const uint64_t) { _cwnd = max(_cwnd, _prior_cwnd); }
+
+void BBR::on_rate_sample(const RateSample &rs) {
+    update_round(rs);
+    update_btlbw(rs);
+    update_rtprop(rs);
+    check_full_pipe(rs);
+    update_mode(rs);
+    update_cwnd(rs);
+}
+
+//! \details A round trip ends when a segment sent after it began is delivered.
+void BBR::update_round(const RateSample &rs) {
+    _round_start = rs.prior_delivered >= _next_round_delivered;
+    if (_round_start) {
+        _next_round_delivered = rs.total_delivered;
+        ++_round_count;
+    }
+}
+
+//! \details An app-limited sample only counts if it beats the estimate, since it can only understate the path.
+void BBR::update_btlbw(const RateSample &rs) {
+    while (!_btlbw_filter.empty() && _btlbw_filter.front().round + BTLBW_FILTER_ROUNDS <= _round_count) {
+        _btlbw_filter.pop_front();
+    }
+    if (rs.delivery_rate == 0 || (rs.app_limited && rs.delivery_rate < btlbw())) {
+        return;
+    }
+    while (!_btlbw_filter.empty() && _btlbw_filter.back().rate <= rs.delivery_rate) {
+        _btlbw_filter.pop_back();
+    }
+    _btlbw_filter.push_back({_round_count, rs.delivery_rate});
+}
+
+void BBR::update_rtprop(const RateSample &rs) {
+    _rtprop_expired = rs.now > _rtprop_stamp + RTPROP_FILTER_MS;
+    if (rs.rtt.has_value() && (!_rtprop.has_value() || *rs.rtt <= *_rtprop || _rtprop_expired)) {
+        _rtprop = rs.rtt;
+        _rtprop_stamp = rs.now;
+    }
+}
+
+//! \details The pipe is full once BtlBw has failed to grow by FULL_BW_GROWTH for FULL_BW_ROUNDS round trips
+//! that weren't app-limited.
+void BBR::check_full_pipe(const RateSample &rs) {
+    if (_filled_pipe || !_round_start || rs.app_limited) {
+        return;
+    }
+    if (double(btlbw()) >= double(_full_bw) * FULL_BW_GROWTH) {
+        _full_bw = btlbw();
+        _full_bw_count = 0;
+        return;
+    }
+    _filled_pipe = ++_full_bw_count >= FULL_BW_ROUNDS;
+}
+
+//! \details A single sender has no other flows to desynchronize from, so ProbeBW always starts in the last
+//! cruising phase rather than a random one, and probes upwards a round trip later.
+void BBR::enter_probe_bw(const uint64_t now) {
+    _mode = Mode::ProbeBW;
+    _cwnd_gain = CWND_GAIN;
+    _cycle_index = GAIN_CYCLE_LENGTH - 1;
+    _cycle_stamp = now;
+    _pacing_gain = PROBE_BW_GAINS[_cycle_index];
+}
+
+//! \details Each ProbeBW phase lasts RTprop, except that the draining phase ends early once the flight is down
+//! to the BDP. ProbeRTT holds the minimum window for PROBE_RTT_MS and at least a round trip, then returns to
+//! where the model left off.
+void BBR::update_mode(const RateSample &rs) {
+    if (_mode == Mode::Startup && _filled_pipe) {
+        _mode = Mode::Drain;
+        _pacing_gain = 1 / HIGH_GAIN;
+        _cwnd_gain = HIGH_GAIN;
+    }
+    if (_mode == Mode::Drain && rs.bytes_in_flight <= bdp(1)) {
+        enter_probe_bw(rs.now);
+    }
+    if (_mode == Mode::ProbeBW) {
+        const bool full_length = rs.now - _cycle_stamp > _rtprop.value_or(0);
+        if (full_length || (_pacing_gain < 1 && rs.bytes_in_flight <= bdp(1))) {
+            _cycle_index = (_cycle_index + 1) % GAIN_CYCLE_LENGTH;
+            _cycle_stamp = rs.now;
+            _pacing_gain = PROBE_BW_GAINS[_cycle_index];
+        }
+    }
+    if (_mode != Mode::ProbeRTT && _rtprop_expired) {
+        _mode = Mode::ProbeRTT;
+        _pacing_gain = 1;
+        _prior_cwnd = _cwnd;
+        _probe_rtt_done.reset();
+    }
+    if (_mode == Mode::ProbeRTT) {
+        if (!_probe_rtt_done.has_value() && rs.bytes_in_flight <= min_cwnd()) {
+            _probe_rtt_done = rs.now + PROBE_RTT_MS;
+            _next_round_delivered = rs.total_delivered;
+            _probe_rtt_round = _round_count + 1;
+        } else if (_probe_rtt_done.has_value() && rs.now >= *_probe_rtt_done && _round_count >= _probe_rtt_round) {
+            _rtprop_stamp = rs.now;
+            _cwnd = max(_cwnd, _prior_cwnd);
+            if (_filled_pipe) {
+                enter_probe_bw(rs.now);
+            } else {
+                _mode = Mode::Startup;
+                _pacing_gain = HIGH_GAIN;
+                _cwnd_gain = HIGH_GAIN;
+            }
+        }
+    }
+}
+
+//! \details cwnd heads for `cwnd_gain` times the BDP, growing by what each acknowledgment delivered; until the
+//! pipe is full it only grows, and until the initial window has been delivered it grows whatever the model says.
+void BBR::update_cwnd(const RateSample &rs) {
+    if (_mode == Mode::ProbeRTT) {
+        _cwnd = min(_cwnd, min_cwnd());
+        return;
+    }
+    const uint64_t target = max(bdp(_cwnd_gain), min_cwnd());
+    if (_filled_pipe) {
+        _cwnd = min(_cwnd + rs.newly_delivered, target);
+    } else if (_cwnd < target || rs.total_delivered < INITIAL_WINDOW_SEGMENTS * _mss) {
+        _cwnd += rs.newly_delivered;
+    }
+    _cwnd = max(_cwnd, min_cwnd());
+}
+
+optional<uint64_t> BBR::pacing_rate() const {
+    if (btlbw() == 0) {
+        return {};
+    }
+    return max<uint64_t>(static_cast<uint64_t>(_pacing_gain * double(btlbw())), 1);
+}
@@ -0,0 +1,324 @@
+#ifndef SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
+#define SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <optional>
+
+//! \brief What the TCPSender knows about an acknowledgment that advanced its window
+struct AckEvent {
+    uint64_t bytes_acked;      //!< payload bytes newly acknowledged
+    uint64_t bytes_in_flight;  //!< sequence space still outstanding after this acknowledgment
+    uint64_t now;              //!< the sender's clock, in milliseconds
+    bool ece = false;          //!< the acknowledgment echoed a congestion experienced mark (ECN)
+};
+
+//! \brief A delivery rate sample, taken by the TCPSender on each acknowledgment that reports data delivered
+//! \details The rate is the data delivered between the transmission of the newest segment this acknowledgment
+//! covers and now, over the longer of the send and ACK intervals that delivery spans
+//! (draft-cheng-iccrg-delivery-rate-estimation).
+struct RateSample {
+    uint64_t delivery_rate;       //!< bytes per second, 0 if the interval is too short to say
+    uint64_t delivered;           //!< bytes delivered over the interval
+    uint64_t interval;            //!< length of the interval, in milliseconds
+    uint64_t prior_delivered;     //!< bytes delivered in all when the newest segment acknowledged was sent
+    uint64_t total_delivered;     //!< bytes delivered in all, cumulatively or selectively
+    uint64_t newly_delivered;     //!< bytes this acknowledgment newly delivered
+    std::optional<uint64_t> rtt;  //!< round-trip time of that segment, if it could be timed, in milliseconds
+    uint64_t bytes_in_flight;     //!< sequence space still outstanding after this acknowledgment
+    uint64_t now;                 //!< the sender's clock, in milliseconds
+    bool app_limited;             //!< the application left the pipe short, so the rate may understate the path
+};
+
+//! \brief A congestion control algorithm, consulted by the TCPSender
+//!
+//! The algorithm owns the congestion window (cwnd) and slow-start threshold (ssthresh).
+//! The TCPSender never keeps more than min(cwnd, receiver window) bytes in flight,
+//! and reports every acknowledgment of new data and every retransmission timeout.
+//! With fast retransmit enabled it also reports the phases of fast recovery ([RFC 6582](\ref rfc::rfc6582)),
+//! during which acknowledgments don't grow the window through on_ack().
+class CongestionControl {
+  public:
+    //! The algorithms that can be selected through TCPConfig
+    enum class Algorithm {
+        None,     //!< no congestion window: fill the receiver's window (the classic CS144 sender)
+        NewReno,  //!< [RFC 5681](\ref rfc::rfc5681) slow start and congestion avoidance
+        Cubic,    //!< [RFC 9438](\ref rfc::rfc9438) CUBIC
+        BBR,      //!< model-based BBR: steers by the measured delivery rate rather than loss, and always paces
+        DCTCP     //!< NewReno, with [RFC 8257](\ref rfc::rfc8257) DCTCP's response to ECN marks
+    };
+
+    static constexpr uint64_t INITIAL_WINDOW_SEGMENTS = 10;  //!< Initial window, in segments (RFC 6928)
+
+  protected:
+    uint64_t _mss;                                             //!< sender maximum segment size, in bytes
+    uint64_t _cwnd;                                            //!< congestion window, in bytes
+    uint64_t _ssthresh{std::numeric_limits<uint64_t>::max()};  //!< slow-start threshold, in bytes
+
+    //! Grow cwnd by at most one MSS per acknowledgment (RFC 5681, section 3.1)
+    void slow_start(const uint64_t bytes_acked);
+
+  public:
+    //! Construct with an initial window of INITIAL_WINDOW_SEGMENTS segments of size `mss`
+    explicit CongestionControl(const size_t mss) : _mss(mss), _cwnd(INITIAL_WINDOW_SEGMENTS * mss) {}
+    virtual ~CongestionControl() = default;
+
+    //! \brief The sender's MSS changed (it was negotiated in the handshake); restart from the initial window
+    //! \note Only meant to be called before any data has been sent
+    void set_mss(const size_t mss) {
+        _mss = mss;
+        _cwnd = INITIAL_WINDOW_SEGMENTS * mss;
+    }
+
+    //! \brief New data was acknowledged
+    virtual void on_ack(const AckEvent &ack) = 0;
+
+    //! \brief The retransmission timer expired with `bytes_in_flight` outstanding
+    virtual void on_timeout(const uint64_t bytes_in_flight, const uint64_t now) = 0;
+
+    //! \brief A loss was detected with `bytes_in_flight` outstanding: lower ssthresh
+    //! \details Shared by on_timeout() and enter_recovery(); cwnd is left for the caller to set.
+    virtual void on_loss(const uint64_t bytes_in_flight, const uint64_t now) = 0;
+
+    //! \name Fast recovery
+    //!@{
+
+    //! Three duplicate ACKs: reduce ssthresh and set cwnd to ssthresh plus the three segments that left the network,
+    //! or to ssthresh alone with `sack`, where the sender's pipe estimate accounts for them (RFC 6675)
+    virtual void enter_recovery(const uint64_t bytes_in_flight, const uint64_t now, const bool sack = false);
+    //! A further duplicate ACK: inflate cwnd by the segment that left the network
+    virtual void on_duplicate_ack() { _cwnd += _mss; }
+    //! An ACK of some but not all of the data outstanding at entry: deflate cwnd by the amount acknowledged
+    virtual void on_partial_ack(const uint64_t bytes_acked);
+    //! An ACK of all the data outstanding at entry: deflate cwnd to ssthresh without allowing a burst
+    virtual void exit_recovery(const uint64_t bytes_in_flight);
+    //!@}
+
+    //! \brief The peer echoed a congestion experienced mark (ECN); reported at most once per window of data,
+    //! and not during fast recovery
+    //! \details The default response is a loss's without the retransmission: ssthresh is lowered, and cwnd set to
+    //! it (RFC 3168, section 6.1.2)
+    virtual void on_ecn_echo(const uint64_t bytes_in_flight, const uint64_t now);
+
+    //! \name Model-based control
+    //!@{
+
+    //! \brief A delivery rate sample was taken; loss-based algorithms ignore it
+    virtual void on_rate_sample(const RateSample &) {}
+    //! \brief The rate to pace new data at, in bytes per second, or empty to leave pacing to TCPConfig
+    virtual std::optional<uint64_t> pacing_rate() const { return {}; }
+    //!@}
+
+    //! \brief A copy of this algorithm, state included
+    virtual std::unique_ptr<CongestionControl> clone() const = 0;
+
+    //! \name Accessors
+    //!@{
+    uint64_t cwnd() const { return _cwnd; }          //!< congestion window, in bytes
+    uint64_t ssthresh() const { return _ssthresh; }  //!< slow-start threshold, in bytes
+    bool in_slow_start() const { return _cwnd < _ssthresh; }
+    //!@}
+
+    //! \brief Construct the algorithm selected by `algorithm`
+    //! \returns nullptr for Algorithm::None
+    static std::unique_ptr<CongestionControl> make(const Algorithm algorithm, const size_t mss);
+};
+
+//! \brief [RFC 5681](\ref rfc::rfc5681) congestion control with byte counting (RFC 3465)
+class NewReno : public CongestionControl {
+  private:
+    uint64_t _bytes_acked_in_avoidance{0};  //!< bytes acknowledged since cwnd last grew in congestion avoidance
+
+  public:
+    using CongestionControl::CongestionControl;
+
+    void on_ack(const AckEvent &ack) override;
+    void on_timeout(const uint64_t bytes_in_flight, const uint64_t now) override;
+    void on_loss(const uint64_t bytes_in_flight, const uint64_t now) override;
+    std::unique_ptr<CongestionControl> clone() const override { return std::make_unique<NewReno>(*this); }
+};
+
+//! \brief [RFC 9438](\ref rfc::rfc9438) CUBIC congestion control
+//! \details cwnd follows W(t) = C * (t - K)^3 + W_max after a congestion event, where W_max is
+//! the window at that event; it never grows slower than the Reno-friendly estimate W_est.
+class Cubic : public CongestionControl {
+  public:
+    static constexpr double C = 0.4;     //!< CUBIC scaling constant, in segments / second^3
+    static constexpr double BETA = 0.7;  //!< multiplicative decrease factor
+
+  private:
+    double _w_max{0};                  //!< window before the last congestion event, in segments
+    double _w_est{0};                  //!< Reno-friendly window estimate, in segments
+    double _k{0};                      //!< seconds the cubic function takes to return to `_w_max`
+    std::optional<uint64_t> _epoch{};  //!< when the current congestion avoidance epoch began, in ms
+    double _cwnd_fraction{0};          //!< growth below one byte carried over between acknowledgments
+
+    //! Start a congestion avoidance epoch at `now`
+    void begin_epoch(const uint64_t now);
+
+  public:
+    using CongestionControl::CongestionControl;
+
+    void on_ack(const AckEvent &ack) override;
+    void on_timeout(const uint64_t bytes_in_flight, const uint64_t now) override;
+    //! Record a congestion event: remember W_max and reduce ssthresh
+    void on_loss(const uint64_t bytes_in_flight, const uint64_t now) override;
+    std::unique_ptr<CongestionControl> clone() const override { return std::make_unique<Cubic>(*this); }
+};
+
+//! \brief BBR congestion control (draft-cardwell-iccrg-bbr-congestion-control, version 1)
+//! \details BBR models the path by its bottleneck bandwidth (BtlBw), the largest delivery rate of the last ten
+//! round trips, and its round-trip propagation time (RTprop), the smallest RTT of the last ten seconds. It paces
+//! at a gain times BtlBw and caps cwnd at twice their product (the BDP). Loss by itself lowers neither, so
+//! random loss doesn't throttle it the way it throttles NewReno and CUBIC; ssthresh is never set.
+class BBR : public CongestionControl {
+  public:
+    //! The phases of the model's life cycle
+    enum class Mode {
+        Startup,  //!< double the sending rate each round trip until BtlBw stops growing
+        Drain,    //!< pace below BtlBw to drain the queue Startup built
+        ProbeBW,  //!< cycle the pacing gain to probe for more bandwidth, then drain what the probe queued
+        ProbeRTT  //!< shrink the flight to MIN_CWND_SEGMENTS to measure RTprop afresh
+    };
+
+    static constexpr double HIGH_GAIN = 2.885;                 //!< 2 / ln 2, the Startup pacing and cwnd gain
+    static constexpr double CWND_GAIN = 2;                     //!< cwnd gain outside Startup and Drain
+    static constexpr unsigned BTLBW_FILTER_ROUNDS = 10;        //!< window of the BtlBw max filter, in round trips
+    static constexpr uint64_t RTPROP_FILTER_MS = 10000;        //!< window of the RTprop min filter, in ms
+    static constexpr uint64_t PROBE_RTT_MS = 200;              //!< time spent in ProbeRTT at the minimum window
+    static constexpr uint64_t MIN_CWND_SEGMENTS = 4;           //!< smallest cwnd, in segments
+    static constexpr unsigned GAIN_CYCLE_LENGTH = 8;           //!< phases of the ProbeBW gain cycle
+    static constexpr double PROBE_BW_GAINS[GAIN_CYCLE_LENGTH] = {1.25, 0.75, 1, 1, 1, 1, 1, 1};
+    static constexpr double FULL_BW_GROWTH = 1.25;             //!< BtlBw growth per round that keeps Startup going
+    static constexpr unsigned FULL_BW_ROUNDS = 3;              //!< rounds without that growth that end Startup
+
+  private:
+    //! a delivery rate and the round trip it was measured in
+    struct BandwidthSample {
+        uint64_t round;
+        uint64_t rate;
+    };
+
+    Mode _mode{Mode::Startup};
+    double _pacing_gain{HIGH_GAIN};
+    double _cwnd_gain{HIGH_GAIN};
+
+    //! the BtlBw max filter: decreasing rates, each the largest since it was measured, oldest first
+    std::deque<BandwidthSample> _btlbw_filter{};
+
+    uint64_t _round_count{0};             //!< round trips counted so far
+    uint64_t _next_round_delivered{0};    //!< total delivered that ends the current round trip
+    bool _round_start{false};             //!< the latest sample began a round trip
+
+    std::optional<uint64_t> _rtprop{};   //!< RTprop, in milliseconds
+    uint64_t _rtprop_stamp{0};            //!< when RTprop was last measured (or confirmed by ProbeRTT)
+    bool _rtprop_expired{false};          //!< the latest sample found RTprop older than RTPROP_FILTER_MS
+
+    uint64_t _full_bw{0};                 //!< BtlBw when it last grew by FULL_BW_GROWTH
+    unsigned _full_bw_count{0};           //!< rounds since then
+    bool _filled_pipe{false};             //!< Startup found the bottleneck bandwidth
+
+    unsigned _cycle_index{0};             //!< the current phase of the ProbeBW gain cycle
+    uint64_t _cycle_stamp{0};             //!< when that phase began
+
+    std::optional<uint64_t> _probe_rtt_done{};  //!< when ProbeRTT may end, once the flight has shrunk
+    uint64_t _probe_rtt_round{0};               //!< the round trip ProbeRTT must also outlast
+    uint64_t _prior_cwnd{0};                    //!< cwnd before recovery or ProbeRTT, restored afterwards
+
+    //! the bandwidth-delay product times `gain`, in bytes (0 while either estimate is missing)
+    uint64_t bdp(const double gain) const;
+    //! the smallest cwnd, in bytes
+    uint64_t min_cwnd() const { return MIN_CWND_SEGMENTS * _mss; }
+
+    void update_round(const RateSample &rs);
+    void update_btlbw(const RateSample &rs);
+    void update_rtprop(const RateSample &rs);
+    void check_full_pipe(const RateSample &rs);
+    void update_mode(const RateSample &rs);
+    void enter_probe_bw(const uint64_t now);
+    void update_cwnd(const RateSample &rs);
+
+  public:
+    using CongestionControl::CongestionControl;
+
+    //! cwnd is set from the rate samples instead
+    void on_ack(const AckEvent &) override {}
+    //! cwnd falls to one segment, to be regrown towards the model's BDP
+    void on_timeout(const uint64_t bytes_in_flight, const uint64_t now) override;
+    //! a loss says nothing about the model
+    void on_loss(const uint64_t, const uint64_t) override {}
+    //! nor does a mark
+    void on_ecn_echo(const uint64_t, const uint64_t) override {}
+
+    //! \name Fast recovery
+    //! cwnd is conserved at the flight size on entry, then grows with the rate samples as usual
+    //!@{
+    void enter_recovery(const uint64_t bytes_in_flight, const uint64_t now, const bool sack = false) override;
+    void on_duplicate_ack() override {}
+    void on_partial_ack(const uint64_t) override {}
+    void exit_recovery(const uint64_t bytes_in_flight) override;
+    //!@}
+
+    void on_rate_sample(const RateSample &rs) override;
+    std::optional<uint64_t> pacing_rate() const override;
+
+    std::unique_ptr<CongestionControl> clone() const override { return std::make_unique<BBR>(*this); }
+
+    //! \name Accessors
+    //!@{
+    Mode mode() const { return _mode; }
+    uint64_t btlbw() const { return _btlbw_filter.empty() ? 0 : _btlbw_filter.front().rate; }  //!< bytes per second
+    std::optional<uint64_t> rtprop() const { return _rtprop; }  //!< milliseconds
+    //!@}
+};
+
+//! \brief [RFC 8257](\ref rfc::rfc8257) DCTCP: NewReno, cutting cwnd in proportion to the extent of congestion
+//! \details alpha, a moving average of the fraction of bytes acknowledged with ECE over each window of data,
+//! sets how far an ECN echo reduces cwnd: by alpha / 2, so only a fully marked window halves it. Losses and
+//! timeouts are handled as by NewReno.
+class DCTCP : public NewReno {
+  public:
+    static constexpr double G = 1.0 / 16;  //!< weight of the latest window in alpha (RFC 8257, section 4.2)
+
+  private:
+    double _alpha{1};           //!< estimated fraction of bytes marked; starts at 1, for a cautious first response
+    uint64_t _window_size;      //!< bytes the current observation window spans: cwnd when it began
+    uint64_t _bytes_acked{0};   //!< bytes acknowledged in the current observation window
+    uint64_t _bytes_marked{0};  //!< those of them acknowledged with ECE
+
+  public:
+    explicit DCTCP(const size_t mss) : NewReno(mss), _window_size(_cwnd) {}
+
+    //! Count the bytes acknowledged with and without ECE, and update alpha at the end of each window
+    void on_ack(const AckEvent &ack) override;
+    void on_ecn_echo(const uint64_t bytes_in_flight, const uint64_t now) override;
+    std::unique_ptr<CongestionControl> clone() const override { return std::make_unique<DCTCP>(*this); }
+
+    double alpha() const { return _alpha; }
+};
+
+//! \brief Owns the sender's CongestionControl (if any), copying it by value when the sender is copied
+class CongestionController {
+  private:
+    std::unique_ptr<CongestionControl> _cc;
+
+  public:
+    explicit CongestionController(std::unique_ptr<CongestionControl> cc = nullptr) : _cc(std::move(cc)) {}
+    CongestionController(const CongestionController &other) : _cc(other._cc ? other._cc->clone() : nullptr) {}
+    CongestionController(CongestionController &&other) = default;
+    CongestionController &operator=(const CongestionController &other) {
+        _cc = other._cc ? other._cc->clone() : nullptr;
+        return *this;
+    }
+    CongestionController &operator=(CongestionController &&other) = default;
+    ~CongestionController() = default;
+
+    //! \returns the algorithm, or nullptr if congestion control is disabled
+    CongestionControl *operator->() const { return _cc.get(); }
+    explicit operator bool() const { return static_cast<bool>(_cc); }
+};
+
+#endif  // SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
@@ -0,0 +1,64 @@
+#include "delivery_rate.hh"
+
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+
+//! \details Only payload counts. Of the segments delivered together, the one sent last (the highest, among those
+//! sent in the same millisecond) starts the send interval of the segments sent from now on.
+void DeliveryRateEstimator::delivered(const OutstandingSegment &outstanding, const uint64_t now) {
+    // the handshake says nothing about the path's bandwidth
+    const uint64_t length = outstanding.payload.size();
+    if (length == 0) {
+        return;
+    }
+    _delivered += length;
+    _delivered_time = now;
+    _newly_delivered += length;
+    if (_app_limited && _delivered > _app_limited) {
+        _app_limited = 0;
+    }
+    if (!_prior.has_value() || outstanding.delivery.sent_at >= _prior->sent_at) {
+        _prior = outstanding.delivery;
+        _prior_timeable = !outstanding.retransmitted;
+        _first_sent_time = outstanding.delivery.sent_at;
+    }
+}
+
+//! \details The interval is the longer of the time the delivered data took to send and the time its
+//! acknowledgments took to arrive, so that neither a burst of sends nor a burst of ACKs inflates the rate.
+optional<RateSample> DeliveryRateEstimator::take_sample(const optional<uint64_t> rtt_sample,
+                                                        const uint64_t bytes_in_flight,
+                                                        const uint64_t now) {
+    if (!_prior.has_value()) {
+        return {};
+    }
+    const DeliverySnapshot prior = *_prior;
+    _prior.reset();
+    const uint64_t newly_delivered = exchange(_newly_delivered, 0);
+    const uint64_t send_elapsed = prior.sent_at - prior.first_sent_time;
+    const uint64_t ack_elapsed = _delivered_time - prior.delivered_time;
+    const uint64_t interval = max(send_elapsed, ack_elapsed);
+    const uint64_t delivered = _delivered - prior.delivered;
+    optional<uint64_t> rtt = rtt_sample;
+    if (!rtt.has_value() && _prior_timeable) {
+        rtt = now - prior.sent_at;
+    }
+    return RateSample{interval ? delivered * 1000 / interval : 0,
+                      delivered,
+                      interval,
+                      prior.delivered,
+                      _delivered,
+                      newly_delivered,
+                      rtt,
+                      bytes_in_flight,
+                      now,
+                      prior.app_limited};
+}
+
+//! \details Samples taken meanwhile are flagged so that a model-based algorithm doesn't mistake the application's
+//! pace for the path's.
+void DeliveryRateEstimator::mark_app_limited(const uint64_t bytes_in_flight) {
+    _app_limited = max<uint64_t>(_delivered + bytes_in_flight, 1);
+}
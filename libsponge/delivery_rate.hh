@@ -0,0 +1,50 @@
+#ifndef SPONGE_LIBSPONGE_DELIVERY_RATE_HH
+#define SPONGE_LIBSPONGE_DELIVERY_RATE_HH
+
+#include "congestion_control.hh"
+#include "outstanding_segment.hh"
+
+#include <cstdint>
+#include <optional>
+
+//! \brief Delivery rate estimation (draft-cheng-iccrg-delivery-rate-estimation)
+//!
+//! Counts the bytes the TCPSender's segments deliver, cumulatively or selectively, and on each acknowledgment
+//! turns what was delivered since the last one into a RateSample for the congestion control.
+class DeliveryRateEstimator {
+  private:
+    uint64_t _delivered{0};        //!< bytes delivered so far
+    uint64_t _delivered_time{0};   //!< when _delivered last grew, or when sending resumed with nothing in flight
+    uint64_t _first_sent_time{0};  //!< the start of the send interval of segments sent from now on
+    uint64_t _app_limited{0};      //!< while nonzero, the pipe is short of data until _delivered passes this value
+
+    //! the snapshot of the most recently sent segment delivered since the last sample, if any
+    std::optional<DeliverySnapshot> _prior{};
+    bool _prior_timeable{false};   //!< that segment can be timed (it wasn't retransmitted)
+    uint64_t _newly_delivered{0};  //!< bytes delivered since the last sample
+
+  public:
+    //! \brief Sending resumes at `now` with nothing in flight: the next sample's intervals start now, not back
+    //! when the pipe emptied
+    void restart(const uint64_t now) { _first_sent_time = _delivered_time = now; }
+
+    //! \brief The delivery counters as they stand at `now`, for a segment being (re)transmitted
+    DeliverySnapshot snapshot(const uint64_t now) const {
+        return {_delivered, _delivered_time, _first_sent_time, now, _app_limited != 0};
+    }
+
+    //! \brief `outstanding` was delivered at `now`: count it, and keep its snapshot if it was sent the latest
+    void delivered(const OutstandingSegment &outstanding, const uint64_t now);
+
+    //! \brief A sample for what was delivered since the last one, if anything was
+    //! \param[in] rtt_sample the RTT the acknowledgment's timestamp measured, if any
+    std::optional<RateSample> take_sample(const std::optional<uint64_t> rtt_sample,
+                                          const uint64_t bytes_in_flight,
+                                          const uint64_t now);
+
+    //! \brief The application left the pipe short with `bytes_in_flight` outstanding: the samples understate
+    //! the path until that data has been delivered
+    void mark_app_limited(const uint64_t bytes_in_flight);
+};
+
+#endif  // SPONGE_LIBSPONGE_DELIVERY_RATE_HH
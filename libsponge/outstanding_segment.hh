@@ -0,0 +1,41 @@
+#ifndef SPONGE_LIBSPONGE_OUTSTANDING_SEGMENT_HH
+#define SPONGE_LIBSPONGE_OUTSTANDING_SEGMENT_HH
+
+#include "buffer.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+//! \brief The TCPSender's delivery counters when a segment was (last) transmitted, from which its delivery
+//! makes a rate sample
+struct DeliverySnapshot {
+    uint64_t delivered = 0;        //!< bytes delivered so far, at the time
+    uint64_t delivered_time = 0;   //!< when that count last grew
+    uint64_t first_sent_time = 0;  //!< when the send interval of the segments sent from then on began
+    uint64_t sent_at = 0;          //!< the sender's clock at the time, in milliseconds
+    bool app_limited = false;      //!< sent while the application had left the pipe short
+};
+
+//! \brief A segment the TCPSender has sent but not yet had acknowledged; its payload shares the sent
+//! segment's storage
+struct OutstandingSegment {
+    Buffer payload;               //!< the payload as sent
+    bool syn;                     //!< whether it carried the SYN
+    bool fin;                     //!< whether it carried the FIN
+    uint64_t sent_at;             //!< the sender's clock when it was first sent, in milliseconds
+    uint64_t xmit_ts;             //!< the sender's clock when it was last (re)transmitted, in milliseconds
+    uint64_t abs_seqno;           //!< absolute sequence number of its first byte
+    bool retransmitted = false;   //!< sent more than once, so its acknowledgment can't be timed (Karn)
+    bool sacked = false;          //!< covered by a SACK block from the receiver
+    bool rescued = false;         //!< retransmitted from the scoreboard in the current recovery
+    bool lost = false;            //!< deemed lost by RACK, and due for retransmission unless `rescued`
+    DeliverySnapshot delivery{};  //!< the delivery counters at its latest transmission
+
+    size_t length_in_sequence_space() const { return payload.size() + syn + fin; }
+};
+
+//! The outstanding segments, oldest first
+using OutstandingSegments = std::deque<OutstandingSegment>;
+
+#endif  // SPONGE_LIBSPONGE_OUTSTANDING_SEGMENT_HH
@@ -0,0 +1,110 @@
+#include "rack_tlp.hh"
+
+#include <algorithm>
+
+using namespace std;
+
+//! \details A retransmitted segment delivered sooner than the minimum RTT after its retransmission is taken to
+//! acknowledge an earlier transmission, and ignored (RFC 8985, section 6.2, step 2).
+void RackTlp::delivered(const OutstandingSegment &outstanding, const uint64_t now) {
+    const uint64_t end_seq = outstanding.abs_seqno + outstanding.length_in_sequence_space();
+    if (!outstanding.retransmitted && end_seq < _fack) {
+        _reordering_seen = true;
+    }
+    _fack = max(_fack, end_seq);
+    const uint64_t rtt = now - outstanding.xmit_ts;
+    if (outstanding.retransmitted && rtt < _min_rtt.value_or(0)) {
+        return;
+    }
+    _min_rtt = min(_min_rtt.value_or(rtt), rtt);
+    if (!_xmit_ts.has_value() || outstanding.xmit_ts > *_xmit_ts ||
+        (outstanding.xmit_ts == *_xmit_ts && end_seq > _end_seq)) {
+        _xmit_ts = outstanding.xmit_ts;
+        _end_seq = end_seq;
+        _rtt = rtt;
+    }
+}
+
+//! \details The reordering window is a quarter of the minimum RTT, capped at SRTT; until reordering has been
+//! seen, it is zero once the DupThresh rule would find a loss or recovery is under way (RFC 8985, section 6.2,
+//! step 4). A segment still within its window arms the reordering timer instead.
+bool RackTlp::detect_loss(OutstandingSegments &outstanding,
+                          const uint64_t now,
+                          const optional<double> srtt,
+                          const bool dupthresh_loss) {
+    _reo_deadline.reset();
+    if (!_xmit_ts.has_value()) {
+        return false;
+    }
+    uint64_t reo_wnd = _min_rtt.value_or(0) / 4;
+    if (srtt.has_value()) {
+        reo_wnd = min(reo_wnd, static_cast<uint64_t>(srtt.value()));
+    }
+    if (!_reordering_seen && dupthresh_loss) {
+        reo_wnd = 0;
+    }
+    bool awaiting = false;
+    for (OutstandingSegment &segment : outstanding) {
+        const uint64_t end_seq = segment.abs_seqno + segment.length_in_sequence_space();
+        const bool sent_before = segment.xmit_ts < *_xmit_ts || (segment.xmit_ts == *_xmit_ts && end_seq < _end_seq);
+        if (segment.sacked || (segment.lost && !segment.rescued) || !sent_before) {
+            awaiting = awaiting || (segment.lost && !segment.rescued && !segment.sacked);
+            continue;
+        }
+        const uint64_t deadline = segment.xmit_ts + _rtt + reo_wnd;
+        if (deadline <= now) {
+            // lost, or its retransmission was: due (again)
+            segment.lost = true;
+            segment.rescued = false;
+            awaiting = true;
+        } else {
+            _reo_deadline = min(_reo_deadline.value_or(deadline), deadline);
+        }
+    }
+    return awaiting;
+}
+
+//! \details PTO is 2 * SRTT (the initial RTO before any sample), plus a worst-case delayed ACK when only one
+//! segment is outstanding (RFC 8985, section 7.2). Only one probe goes out until an ACK covers it.
+void RackTlp::arm_pto(const OutstandingSegments &outstanding,
+                      const uint64_t now,
+                      const optional<double> srtt,
+                      const uint64_t initial_rto,
+                      const optional<uint64_t> rto_left) {
+    _pto_deadline.reset();
+    if (_tlp_end_seq.has_value()) {
+        return;
+    }
+    uint64_t pto = srtt.has_value() ? static_cast<uint64_t>(2 * srtt.value()) : initial_rto;
+    if (outstanding.size() == 1) {
+        pto += WORST_CASE_DELAYED_ACK;
+    }
+    if (rto_left.has_value()) {
+        pto = min(pto, *rto_left);
+    }
+    _pto_deadline = now + pto;
+}
+
+void RackTlp::probe_sent(const uint64_t end_seq, const bool retransmitted) {
+    _pto_deadline.reset();
+    _tlp_end_seq = end_seq;
+    _tlp_retransmitted = retransmitted;
+}
+
+//! \details With no D-SACK to say a resent probe only duplicated a delivered segment, it is taken to have
+//! repaired a loss, which calls for the same response as a fast recovery (RFC 8985, section 7.4.2).
+bool RackTlp::probe_acknowledged(const uint64_t ackno) {
+    if (!_tlp_end_seq.has_value() || ackno < *_tlp_end_seq) {
+        return false;
+    }
+    _tlp_end_seq.reset();
+    return _tlp_retransmitted;
+}
+
+void RackTlp::reset(OutstandingSegments &outstanding) {
+    for (OutstandingSegment &segment : outstanding) {
+        segment.lost = false;
+    }
+    _reo_deadline.reset();
+    _tlp_end_seq.reset();
+}
@@ -0,0 +1,75 @@
+#ifndef SPONGE_LIBSPONGE_RACK_TLP_HH
+#define SPONGE_LIBSPONGE_RACK_TLP_HH
+
+#include "outstanding_segment.hh"
+
+#include <cstdint>
+#include <optional>
+
+//! \brief RACK-TLP loss detection, per [RFC 8985](\ref rfc::rfc8985)
+//!
+//! RACK deems the TCPSender's outstanding segments lost by when they were sent, relative to the latest
+//! transmission known to have been delivered, rather than by counting duplicate ACKs. TLP arms a probe
+//! timeout (PTO) so that a loss at the tail of the data, which no later delivery can reveal, elicits an ACK
+//! sooner than the retransmission timer would.
+class RackTlp {
+  public:
+    static constexpr uint64_t WORST_CASE_DELAYED_ACK = 200;  //!< WCDelAckT, in milliseconds
+
+  private:
+    std::optional<uint64_t> _xmit_ts{};       //!< RACK.xmit_ts: the latest transmission known delivered
+    uint64_t _end_seq{0};                     //!< RACK.end_seq: the absolute seqno ending that transmission
+    uint64_t _rtt{0};                         //!< RACK.rtt: its round-trip time, in milliseconds
+    std::optional<uint64_t> _min_rtt{};       //!< the smallest RACK.rtt, a quarter of which is the reordering window
+    uint64_t _fack{0};                        //!< RACK.fack: the highest absolute seqno delivered
+    bool _reordering_seen{false};             //!< a segment was delivered below RACK.fack, never retransmitted
+    std::optional<uint64_t> _reo_deadline{};  //!< when the earliest undecided segment's reordering window runs out
+    std::optional<uint64_t> _pto_deadline{};  //!< when the tail loss probe is due, if armed
+    std::optional<uint64_t> _tlp_end_seq{};   //!< the absolute seqno ending the data outstanding at the last probe
+    bool _tlp_retransmitted{false};           //!< the last probe resent data rather than sending new data
+
+  public:
+    //! \brief `outstanding` was delivered, at `now`: advance RACK.xmit_ts if it was sent later than what is
+    //! known delivered
+    void delivered(const OutstandingSegment &outstanding, const uint64_t now);
+
+    //! \brief Mark `lost` the segments sent more than a reordering window before RACK.xmit_ts and still
+    //! undelivered RACK.rtt later
+    //! \param[in] dupthresh_loss recovery is under way, or the DupThresh rule finds a loss
+    //! \returns whether any segment deemed lost awaits retransmission
+    bool detect_loss(OutstandingSegments &outstanding,
+                     const uint64_t now,
+                     const std::optional<double> srtt,
+                     const bool dupthresh_loss);
+
+    //! \brief Whether a reordering window left a segment undecided, and has run out by `now`
+    bool reordering_timer_expired(const uint64_t now) const {
+        return _reo_deadline.has_value() && *_reo_deadline <= now;
+    }
+
+    //! \brief Restart the PTO at `now`, unless a probe is still unacknowledged
+    //! \param[in] rto_left the time left on the retransmission timer, if it is running, which the PTO never outlasts
+    void arm_pto(const OutstandingSegments &outstanding,
+                 const uint64_t now,
+                 const std::optional<double> srtt,
+                 const uint64_t initial_rto,
+                 const std::optional<uint64_t> rto_left);
+
+    //! \brief Stop the PTO
+    void disarm_pto() { _pto_deadline.reset(); }
+
+    //! \brief Whether the PTO is armed and has expired by `now`
+    bool pto_expired(const uint64_t now) const { return _pto_deadline.has_value() && *_pto_deadline <= now; }
+
+    //! \brief A probe went out, ending with outstanding data at absolute seqno `end_seq`
+    void probe_sent(const uint64_t end_seq, const bool retransmitted);
+
+    //! \brief An acknowledgment of absolute seqno `ackno` arrived
+    //! \returns whether it covered a probe that resent data, which is taken to have repaired a loss
+    bool probe_acknowledged(const uint64_t ackno);
+
+    //! \brief The retransmission timer expired: drop the `lost` marks, the reordering timer and any probe
+    void reset(OutstandingSegments &outstanding);
+};
+
+#endif  // SPONGE_LIBSPONGE_RACK_TLP_HH
@@ -0,0 +1,23 @@
+#include "rtt_estimator.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+RTTEstimator::RTTEstimator(const unsigned int initial_rto, const unsigned int min_rto, const unsigned int max_rto)
+    : _min_rto(min_rto), _max_rto(max_rto), _rto(initial_rto) {}
+
+void RTTEstimator::add_sample(const uint64_t rtt) {
+    const double r = double(rtt);
+    if (_srtt.has_value()) {
+        // RTTVAR is updated first, with the SRTT from before this sample (RFC 6298, 2.3)
+        _rttvar = (1 - BETA) * _rttvar + BETA * abs(_srtt.value() - r);
+        _srtt = (1 - ALPHA) * _srtt.value() + ALPHA * r;
+    } else {
+        _srtt = r;
+        _rttvar = r / 2;
+    }
+    const double rto = ceil(_srtt.value() + max(G, K * _rttvar));
+    _rto = static_cast<unsigned int>(clamp(rto, double(_min_rto), double(_max_rto)));
+}
@@ -0,0 +1,43 @@
+#ifndef SPONGE_LIBSPONGE_RTT_ESTIMATOR_HH
+#define SPONGE_LIBSPONGE_RTT_ESTIMATOR_HH
+
+#include <cstdint>
+#include <optional>
+
+//! \brief Round-trip time estimation and retransmission timeout, per [RFC 6298](\ref rfc::rfc6298)
+//!
+//! Fed one RTT measurement at a time, keeps the smoothed RTT (SRTT) and its mean deviation
+//! (RTTVAR) and derives RTO = SRTT + max(G, 4 * RTTVAR), clamped to [min_rto, max_rto].
+class RTTEstimator {
+  public:
+    static constexpr double ALPHA = 1.0 / 8;  //!< gain of SRTT
+    static constexpr double BETA = 1.0 / 4;   //!< gain of RTTVAR
+    static constexpr double K = 4;            //!< weight of RTTVAR in the RTO
+    static constexpr double G = 1;            //!< clock granularity, in milliseconds (the tick() resolution)
+
+  private:
+    unsigned int _min_rto;
+    unsigned int _max_rto;
+    std::optional<double> _srtt{};  //!< smoothed RTT, in milliseconds; empty before the first sample
+    double _rttvar{0};              //!< RTT mean deviation, in milliseconds
+    unsigned int _rto;              //!< current retransmission timeout, in milliseconds
+
+  public:
+    //! \param[in] initial_rto the RTO to use before the first sample, in milliseconds
+    //! \param[in] min_rto lower bound on the RTO, in milliseconds
+    //! \param[in] max_rto upper bound on the RTO, in milliseconds
+    RTTEstimator(const unsigned int initial_rto, const unsigned int min_rto, const unsigned int max_rto);
+
+    //! \brief Update the estimate with one RTT measurement, in milliseconds
+    //! \note Per Karn's algorithm, the caller must not measure segments that were retransmitted.
+    void add_sample(const uint64_t rtt);
+
+    //! \name Accessors
+    //!@{
+    std::optional<double> smoothed_rtt() const { return _srtt; }  //!< SRTT, empty before the first sample
+    double rtt_variation() const { return _rttvar; }              //!< RTTVAR
+    unsigned int rto() const { return _rto; }                     //!< retransmission timeout for a fresh timer
+    //!@}
+};
+
+#endif  // SPONGE_LIBSPONGE_RTT_ESTIMATOR_HH
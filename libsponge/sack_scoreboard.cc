@@ -0,0 +1,105 @@
+#include "sack_scoreboard.hh"
+
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+
+//! \details Besides the marks, the highest SACKed segments are kept aside, so that lost_prefix() need not
+//! scan the outstanding segments on every acknowledgment.
+void SackScoreboard::mark(OutstandingSegments &outstanding,
+                          const uint64_t left,
+                          const uint64_t right,
+                          const function<void(const OutstandingSegment &)> &on_sacked) {
+    auto it = partition_point(outstanding.begin(), outstanding.end(), [&](const OutstandingSegment &segment) {
+        return segment.abs_seqno < left;
+    });
+    for (; it != outstanding.end(); ++it) {
+        const uint64_t seg_len = it->length_in_sequence_space();
+        if (it->abs_seqno + seg_len > right) {
+            break;
+        }
+        if (it->sacked) {
+            continue;
+        }
+        it->sacked = true;
+        _sacked_bytes += seg_len;
+        _newly_sacked += seg_len;
+        ++_sacked_segments;
+        on_sacked(*it);
+        if (_highest_count == DUP_THRESH) {
+            if (it->abs_seqno < _highest[0].abs_seqno) {
+                continue;
+            }
+            move(_highest.begin() + 1, _highest.end(), _highest.begin());
+            --_highest_count;
+        }
+        size_t i = _highest_count++;
+        for (; i > 0 && _highest[i - 1].abs_seqno > it->abs_seqno; --i) {
+            _highest[i] = _highest[i - 1];
+        }
+        _highest[i] = {it->abs_seqno, seg_len};
+    }
+}
+
+//! \details Segments are acknowledged oldest first, so one still among the highest SACKed means there are
+//! no other SACKed segments below it.
+void SackScoreboard::acknowledged(const OutstandingSegment &outstanding) {
+    if (!outstanding.sacked) {
+        return;
+    }
+    _sacked_bytes -= outstanding.length_in_sequence_space();
+    --_sacked_segments;
+    if (_highest_count > 0 && _highest[0].abs_seqno == outstanding.abs_seqno) {
+        move(_highest.begin() + 1, _highest.begin() + _highest_count, _highest.begin());
+        --_highest_count;
+    }
+}
+
+//! \details See [RFC 2018](\ref rfc::rfc2018), section 8.
+void SackScoreboard::reset(OutstandingSegments &outstanding) {
+    for (OutstandingSegment &segment : outstanding) {
+        segment.sacked = false;
+    }
+    _sacked_bytes = 0;
+    _sacked_segments = 0;
+    _newly_sacked = 0;
+    _highest_count = 0;
+}
+
+//! \details The segments from the lowest of the highest SACKed ones that add up to DupThresh segments or
+//! (DupThresh - 1) * `mss` bytes upwards are all SACKed: everything older is deemed lost. Only that entry's
+//! place is searched for, in O(log n).
+size_t SackScoreboard::lost_prefix(const OutstandingSegments &outstanding, const size_t mss) const {
+    uint64_t sacked_above = 0;
+    for (size_t i = _highest_count; i > 0; --i) {
+        sacked_above += _highest[i - 1].length;
+        const size_t sacked_segments_above = _highest_count - i + 1;
+        if (sacked_segments_above < DUP_THRESH && sacked_above <= (DUP_THRESH - 1) * mss) {
+            continue;
+        }
+        const uint64_t threshold_seqno = _highest[i - 1].abs_seqno;
+        const size_t older =
+            partition_point(outstanding.begin(),
+                            outstanding.end(),
+                            [&](const OutstandingSegment &segment) { return segment.abs_seqno < threshold_seqno; }) -
+            outstanding.begin();
+        // nothing is lost if every older segment is SACKed too
+        return _sacked_segments - sacked_segments_above < older ? older : 0;
+    }
+    return 0;
+}
+
+//! \details pipe counts each unSACKed segment once if it is not deemed lost, and once more if it was rescued
+//! (RFC 6675, section 4).
+void SackScoreboard::update_pipe(const OutstandingSegments &outstanding, const size_t lost) {
+    _pipe = 0;
+    for (size_t i = 0; i < outstanding.size(); ++i) {
+        const OutstandingSegment &segment = outstanding[i];
+        if (!segment.sacked) {
+            _pipe += segment.length_in_sequence_space() * (!deemed_lost(outstanding, i, lost) + segment.rescued);
+        }
+    }
+}
+
+uint64_t SackScoreboard::take_newly_sacked() { return exchange(_newly_sacked, 0); }
@@ -0,0 +1,75 @@
+#ifndef SPONGE_LIBSPONGE_SACK_SCOREBOARD_HH
+#define SPONGE_LIBSPONGE_SACK_SCOREBOARD_HH
+
+#include "outstanding_segment.hh"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+//! \brief The SACK scoreboard of [RFC 6675](\ref rfc::rfc6675)
+//!
+//! Keeps the `sacked` marks on the TCPSender's outstanding segments, tells which of them are deemed lost,
+//! and estimates the bytes still in the network (pipe) during SACK-based loss recovery.
+class SackScoreboard {
+  public:
+    static constexpr unsigned DUP_THRESH = 3;  //!< DupThresh: SACKed segments above a hole that make it a loss
+
+  private:
+    //! a SACKed segment, by its place in sequence space
+    struct SackedSegment {
+        uint64_t abs_seqno = 0;  //!< absolute sequence number of its first byte
+        uint64_t length = 0;     //!< its length in sequence space
+    };
+
+    uint64_t _sacked_bytes{0};     //!< sequence space of the outstanding segments marked `sacked`
+    size_t _sacked_segments{0};    //!< number of the outstanding segments marked `sacked`
+    uint64_t _newly_sacked{0};     //!< sequence space newly marked since take_newly_sacked()
+    uint64_t _pipe{0};             //!< bytes still in the network, as of the last update_pipe()
+
+    //! the (up to) DupThresh highest SACKed segments, lowest first: all lost_prefix() needs to look at
+    std::array<SackedSegment, DUP_THRESH> _highest{};
+    size_t _highest_count{0};  //!< how many entries of _highest are in use
+
+  public:
+    //! \brief Mark the segments lying wholly within absolute seqnos [left, right) as SACKed
+    //! \param on_sacked called with each segment that was not marked before
+    void mark(OutstandingSegments &outstanding,
+              const uint64_t left,
+              const uint64_t right,
+              const std::function<void(const OutstandingSegment &)> &on_sacked);
+
+    //! \brief `outstanding` is being removed, cumulatively acknowledged
+    void acknowledged(const OutstandingSegment &outstanding);
+
+    //! \brief The receiver may renege on SACKed data: drop every mark
+    void reset(OutstandingSegments &outstanding);
+
+    //! \brief The oldest segments up to the returned index are deemed lost, unless SACKed themselves: those with
+    //! more than (DupThresh - 1) * `mss` bytes or at least DupThresh segments SACKed above them
+    //! \returns 0 if no segment is deemed lost
+    size_t lost_prefix(const OutstandingSegments &outstanding, const size_t mss) const;
+
+    //! \brief Whether segment `i` is deemed lost and not SACKed, given `lost` from lost_prefix() (or RACK's marks)
+    static bool deemed_lost(const OutstandingSegments &outstanding, const size_t i, const size_t lost) {
+        return !outstanding[i].sacked && (i < lost || outstanding[i].lost);
+    }
+
+    //! \brief Recompute pipe, given `lost` from lost_prefix() (0 with RACK)
+    void update_pipe(const OutstandingSegments &outstanding, const size_t lost);
+
+    //! \brief The sequence space newly SACKed since the previous call, as an acknowledgment reports it delivered
+    uint64_t take_newly_sacked();
+
+    //! \brief `length` more bytes were sent, new or retransmitted, adding to pipe
+    void sent(const uint64_t length) { _pipe += length; }
+
+    //! \name Accessors
+    //!@{
+    uint64_t sacked_bytes() const { return _sacked_bytes; }  //!< sequence space marked `sacked`
+    uint64_t pipe() const { return _pipe; }                  //!< bytes still in the network
+    //!@}
+};
+
+#endif  // SPONGE_LIBSPONGE_SACK_SCOREBOARD_HH
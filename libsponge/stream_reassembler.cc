@@ -1,54 +1,185 @@
 #include "stream_reassembler.hh"
 
+#include <iterator>
+
 using namespace std;
 
-//!< Try to push all the in-order char in map into the output stream
+//!< Try to push the run starting at nextToPush into the output stream
 void StreamReassembler::try_output() {
-    string toPush = "";
-    while (map.find(nextToPush) != map.end()) {
-        toPush += map[nextToPush];
-        map.erase(nextToPush);
-        if (EOFSeen && nextToPush == streamEOF) {
-            output.end_input();
+    if (backend == Backend::Bitmap) {
+        const size_t run = ring.run_length(nextToPush);
+        if (run > 0) {
+            string toPush;
+            toPush.reserve(run);
+            ring.extract(nextToPush, run, toPush);
+            output.write(toPush);
+            nextToPush += run;
+        }
+    } else if (!segments.empty() && segments.begin()->first == nextToPush) {
+        // runs never touch each other, so at most the first one can be written
+        Run &run = segments.begin()->second;
+        for (auto &slice : run.slices) {
+            output.write(move(slice));
+        }
+        nextToPush += run.size;
+        unassembledBytes -= run.size;
+        segments.erase(segments.begin());
+    }
+    if (EOFSeen && nextToPush == streamEOF) {
+        output.end_input();
+    }
+}
+
+//! \details Only the gaps between the runs held are filled, each with a slice sharing the storage of `data`;
+//! the new bytes and every run they overlap or touch then become a single run, so the map keeps one entry
+//! per contiguous range however the bytes arrived.
+void StreamReassembler::insert_segment(const Buffer &data, const uint64_t index) {
+    const uint64_t end = index + data.size();
+    uint64_t start = index;   // the first index of the merged run
+    uint64_t cursor = index;  // the bytes before it are in `run`
+    Run run{};
+    auto it = segments.upper_bound(index);
+    if (it != segments.begin()) {
+        const auto prev = std::prev(it);
+        const uint64_t prev_end = prev->first + prev->second.size;
+        if (prev_end >= end) {
+            return;
+        }
+        if (prev_end >= index) {
+            start = prev->first;
+            cursor = prev_end;
+            run = move(prev->second);
+            segments.erase(prev);
+        }
+    }
+    // take in each gap before a run starting at or before `end`, then that run
+    for (; it != segments.end() && it->first <= end; it = segments.erase(it)) {
+        if (cursor < it->first) {
+            append_slice(run, data.substr(cursor - index, it->first - cursor));
+            unassembledBytes += it->first - cursor;
         }
-        ++nextToPush;
+        cursor = it->first + it->second.size;
+        join_runs(run, move(it->second));
+    }
+    if (cursor < end) {
+        append_slice(run, data.substr(cursor - index, end - cursor));
+        unassembledBytes += end - cursor;
+    }
+    segments.emplace_hint(it, start, move(run));
+}
+
+//! \details Joining keeps a run of tiny segments from turning into as many slices, and copying a small
+//! slice keeps it from holding a much larger Buffer alive.
+void StreamReassembler::append_slice(Run &run, Buffer slice) {
+    run.size += slice.size();
+    if (!run.slices.empty() && run.slices.back().size() + slice.size() <= SLICE_JOIN_SIZE) {
+        string joined = run.slices.back().copy();
+        joined.append(slice.str());
+        run.slices.back() = Buffer{move(joined)};
+    } else if (slice.size() * SLICE_COPY_RATIO < slice.storage_size()) {
+        run.slices.emplace_back(slice.copy());
+    } else {
+        run.slices.push_back(move(slice));
+    }
+}
+
+//! \details The run with fewer slices is the one moved, so merging runs costs O(n log n) slice moves overall
+//! in whatever order the gaps between them are filled.
+void StreamReassembler::join_runs(Run &run, Run &&next) {
+    if (next.slices.size() > run.slices.size()) {
+        while (!run.slices.empty()) {
+            next.slices.push_front(move(run.slices.back()));
+            run.slices.pop_back();
+        }
+        next.size += run.size;
+        run = move(next);
+        return;
     }
-    if (!toPush.empty()) {
-        output.write(toPush);
+    for (auto &slice : next.slices) {
+        append_slice(run, move(slice));
     }
 }
 
-StreamReassembler::StreamReassembler(const size_t _capacity)
-    : map(), output(_capacity), capacity(_capacity), nextToPush(0), streamEOF(0), EOFSeen(false) {}
+StreamReassembler::StreamReassembler(const size_t _capacity, const Backend _backend)
+    : backend(_backend)
+    , ring(_backend == Backend::Bitmap ? _capacity : 0)
+    , segments()
+    , output(_capacity)
+    , capacity(_capacity)
+    , nextToPush(0)
+    , streamEOF(0)
+    , EOFSeen(false)
+    , unassembledBytes(0)
+    , pushCount(0)
+    , fastPathCount(0) {}
+
+//! \details A std::string is copied into a Buffer only for the part that has to wait out of order;
+//! a Buffer is never copied here, its accepted bytes are kept as slices sharing its storage.
+template <typename Data>
+void StreamReassembler::assemble(const Data &data, const uint64_t index, const bool eof) {
+    ++pushCount;
+    if (eof) {
+        EOFSeen = true;
+        streamEOF = index + data.size();
+    }
+    // the accept range is [nextToPush, first_unread() + capacity)
+    const uint64_t begin = max<uint64_t>(index, nextToPush);
+    const uint64_t end = min<uint64_t>(index + data.size(), first_unread() + capacity);
+    if (begin == nextToPush && begin < end && empty()) {
+        // fast path: in-order data with nothing buffered goes straight into the stream,
+        // anything beyond the window is dropped without touching the map
+        ++fastPathCount;
+        if (begin == index && end == index + data.size()) {
+            output.write(data);
+        } else {
+            output.write(data.substr(begin - index, end - begin));
+        }
+        nextToPush = end;
+    } else if (begin < end && backend == Backend::Bitmap) {
+        ring.insert(begin, string_view(data).substr(begin - index, end - begin));
+    } else if (begin < end) {
+        insert_segment(Buffer{data.substr(begin - index, end - begin)}, begin);
+    }
+    try_output();
+}
 
 //! \details This function accepts a substring (aka a segment) of bytes,
 //! possibly out-of-order, from the logical stream, and assembles any newly
 //! contiguous substrings and writes them into the output stream in order.
 void StreamReassembler::push_substring(const string &data, const uint64_t index, const bool eof) {
-    if (eof) {
-        EOFSeen = true;
-        streamEOF = index + data.size() - 1;
-        if (data.size() == 0 && unassembled_bytes() == 0 && nextToPush == index) {
-            // special treatment for empty string
-            output.end_input();
+    assemble(data, index, eof);
+}
+
+void StreamReassembler::push_substring(const Buffer &data, const uint64_t index, const bool eof) {
+    assemble(data, index, eof);
+}
+
+size_t StreamReassembler::unassembled_bytes() const {
+    return backend == Backend::Bitmap ? ring.count() : unassembledBytes;
+}
+
+//! \details The map backend holds one run per range; the bitmap backend alternates hole and run scans
+//! over the window, so neither allocates.
+size_t StreamReassembler::held_ranges(Range *out, const size_t max) const {
+    size_t count = 0;
+    if (backend == Backend::Bitmap) {
+        const uint64_t window_end = first_unread() + capacity;
+        uint64_t cursor = nextToPush;
+        while (count < max && cursor < window_end && ring.count()) {
+            cursor += ring.hole_length(cursor, window_end - cursor);
+            if (cursor >= window_end) {
+                break;
+            }
+            const size_t run = ring.run_length(cursor);
+            out[count++] = {cursor, cursor + run};
+            cursor += run;
         }
-        try_output();
+        return count;
     }
-    if ((nextToPush + capacity - 1 < index) || (index + data.size() - 1 < nextToPush)) {
-        // for sure either too far in future or too old in history
-        return;
-    }
-    size_t first_unread_index = first_unread();
-    for (uint64_t i = index; i < index + data.size(); ++i) {
-        // the accept range is [nextToPush, nextToPush + remaining_capacity() - 1]
-        if (nextToPush <= i && i < first_unread_index + capacity) {
-            // add this char to storage(not unassembled)
-            map[i] = data[i - index];
-            try_output();
-        }
+    for (auto it = segments.begin(); it != segments.end() && count < max; ++it) {
+        out[count++] = {it->first, it->first + it->second.size};
     }
+    return count;
 }
 
-size_t StreamReassembler::unassembled_bytes() const { return map.size(); }
-
-bool StreamReassembler::empty() const { return map.empty(); }
+bool StreamReassembler::empty() const { return unassembled_bytes() == 0; }
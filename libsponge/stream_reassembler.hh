@@ -1,24 +1,58 @@
 #ifndef SPONGE_LIBSPONGE_STREAM_REASSEMBLER_HH
 #define SPONGE_LIBSPONGE_STREAM_REASSEMBLER_HH
 
+#include "bitmap_ring.hh"
+#include "buffer.hh"
 #include "byte_stream.hh"
 
 #include <cstdint>
+#include <deque>
 #include <iostream>
+#include <map>
 #include <string>
-#include <unordered_map>
 
 //! \brief A class that assembles a series of excerpts from a byte stream (possibly out of order,
 //! possibly overlapping) into an in-order byte stream.
 class StreamReassembler {
+  public:
+    //! Where out-of-order bytes are kept until they can be assembled
+    enum class Backend {
+        Map,    //!< Merged runs of refcounted slices in an ordered map; memory grows with the bytes and holes held
+        Bitmap  //!< A BitmapRing of `capacity` bytes; fixed memory, O(1) unassembled_bytes()
+    };
+
+    //! A run of bytes held out of order, covering the stream indices [begin, end)
+    struct Range {
+        uint64_t begin;  //!< index of the first byte of the run
+        uint64_t end;    //!< index just past the last byte of the run
+    };
+
   private:
+    //! A slice under 1/SLICE_COPY_RATIO of its Buffer's storage is copied, so the slices held never keep
+    //! more than SLICE_COPY_RATIO * capacity bytes alive
+    static constexpr size_t SLICE_COPY_RATIO = 4;
+    //! Neighbouring slices in a run are joined by copying while together they are no longer than this
+    static constexpr size_t SLICE_JOIN_SIZE = 256;
+
+    //! Contiguous out-of-order bytes, held as consecutive slices
+    struct Run {
+        std::deque<Buffer> slices{};
+        size_t size = 0;  //!< The total size of `slices`
+    };
+
     // Your code here -- add private members as necessary.
-    std::unordered_map<uint64_t, char> map;
-    ByteStream output;  //!< The reassembled in-order byte stream
-    size_t capacity;    //!< The maximum number of bytes
-    size_t nextToPush;  //!< The index of next char to be pushed into the stream
-    size_t streamEOF;   //!< The last index to be pushed before finish
+    Backend backend;
+    BitmapRing ring;  //!< Out-of-order bytes with Backend::Bitmap (zero-sized otherwise)
+    //! Out-of-order bytes as non-overlapping, non-adjacent runs keyed by the index of their first byte
+    std::map<uint64_t, Run> segments;
+    ByteStream output;         //!< The reassembled in-order byte stream
+    size_t capacity;           //!< The maximum number of bytes
+    size_t nextToPush;         //!< The index of next char to be pushed into the stream
+    size_t streamEOF;          //!< The index one past the last byte of the stream
     bool EOFSeen;
+    size_t unassembledBytes;  //!< The total size of the runs in `segments`
+    size_t pushCount;         //!< The number of calls to push_substring
+    size_t fastPathCount;     //!< The number of those calls written straight into the output stream
 
     // functions:
     size_t remain_capacity() const {
@@ -26,13 +60,26 @@ class StreamReassembler {
     }  //!< The remaining capacity we have for the reassembler
     size_t output_not_read() const { return output.buffer_size(); }  //!< The remaining unread char length in stream
     size_t first_unread() const { return nextToPush - output_not_read(); }  //!< The first unread index
-    void try_output();  //!< Try to push all the in-order char in map into the output stream
+    void try_output();  //!< Try to push the run starting at nextToPush into the output stream
+
+    //! Store the parts of [index, index + data.size()) that no run holds yet, merging the runs it touches
+    void insert_segment(const Buffer &data, const uint64_t index);
+
+    //! Append `slice` to `run`, joining it to the last slice or copying it out of its storage if small
+    static void append_slice(Run &run, Buffer slice);
+
+    //! Append the run `next`, which starts where `run` ends, to `run`
+    static void join_runs(Run &run, Run &&next);
+
+    //! Shared body of the push_substring overloads (`Data` is std::string or Buffer)
+    template <typename Data>
+    void assemble(const Data &data, const uint64_t index, const bool eof);
 
   public:
     //! \brief Construct a `StreamReassembler` that will store up to `capacity` bytes.
     //! \note This capacity limits both the bytes that have been reassembled,
     //! and those that have not yet been reassembled.
-    StreamReassembler(const size_t capacity);
+    StreamReassembler(const size_t capacity, const Backend backend = Backend::Map);
 
     //! \brief Receive a substring and write any newly contiguous bytes into the stream.
     //!
@@ -44,6 +91,10 @@ class StreamReassembler {
     //! \param eof the last byte of `data` will be the last byte in the entire stream
     void push_substring(const std::string &data, const uint64_t index, const bool eof);
 
+    //! \brief Receive a substring held in a Buffer; out-of-order bytes are kept as slices of it instead of copies
+    //! \copydetails push_substring(const std::string &, const uint64_t, const bool)
+    void push_substring(const Buffer &data, const uint64_t index, const bool eof);
+
     //! \name Access the reassembled byte stream
     //!@{
     const ByteStream &stream_out() const { return output; }
@@ -56,6 +107,11 @@ class StreamReassembler {
     //! should only be counted once for the purpose of this function.
     size_t unassembled_bytes() const;
 
+    //! \brief The runs of bytes held out of order, lowest first, with touching runs merged
+    //! \param[out] out receives at most `max` runs
+    //! \returns the number of runs written
+    size_t held_ranges(Range *out, const size_t max) const;
+
     //! \brief Is the internal state empty (other than the output stream)?
     //! \returns `true` if no substrings are waiting to be assembled
     bool empty() const;
@@ -67,6 +123,15 @@ class StreamReassembler {
     size_t first_unassembled() const { return nextToPush; }  //!< The first unassembled index
 
     size_t checkpoint() const { return nextToPush - 1; }  //!< The last reassembled byte index
+
+    //! \name Statistics of the in-order fast path
+    //!@{
+    size_t pushes() const { return pushCount; }                //!< Number of substrings pushed so far
+    size_t fast_path_pushes() const { return fastPathCount; }  //!< Number that bypassed the out-of-order map
+    //!@}
+
+    //! The number of contiguous runs of out-of-order bytes held (Backend::Map; 0 with Backend::Bitmap)
+    size_t stored_runs() const { return segments.size(); }
 };
 
 #endif  // SPONGE_LIBSPONGE_STREAM_REASSEMBLER_HH
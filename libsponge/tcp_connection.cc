@@ -1,22 +1,66 @@
 #include "tcp_connection.hh"
 
+#include <algorithm>
 #include <iostream>
+#include <utility>
 
 using namespace std;
 
 void TCPConnection::send_sender_segments() {
-    // clear sender's outstream
-    TCPSegment temp;
+    // clear sender's outstream, moving each segment to ours and finishing its header there
     while (!_sender.segments_out().empty()) {
-        temp = _sender.segments_out().front();
+        _segments_out.push(move(_sender.segments_out().front()));
         _sender.segments_out().pop();
+        TCPSegment &temp = _segments_out.back();
+        if (temp.header().syn && _cfg.window_scaling &&
+            (!_receiver.ackno().has_value() || _peer_window_scale.has_value())) {
+            // offer window scaling in an active open, or answer the peer's offer
+            temp.header().wscale = _receiver.wanted_window_shift();
+            _window_scale_offered = true;
+        }
+        if (temp.header().syn) {
+            temp.header().mss = static_cast<uint16_t>(min(_cfg.mss, TCPConfig::MAX_MSS));
+        }
+        if (temp.header().syn && _cfg.timestamps && (!_receiver.ackno().has_value() || _peer_timestamps)) {
+            _timestamps_offered = true;
+        }
+        if (_timestamps_offered && (temp.header().syn || timestamps_enabled())) {
+            // TSecr is only meaningful on an ACK, and set before the SACK blocks claim the remaining room
+            temp.header().timestamps = TCPHeader::Timestamps{static_cast<uint32_t>(_clock), _ts_recent};
+        }
+        if (temp.header().syn && _cfg.sack && (!_receiver.ackno().has_value() || _peer_sack_permitted)) {
+            temp.header().sack_permitted = true;
+            _sack_offered = true;
+        }
+        if (temp.header().syn && _cfg.ecn && (!_receiver.ackno().has_value() || _peer_ecn)) {
+            // an ECN-setup SYN sets ECE and CWR, the SYN/ACK answering it ECE alone (RFC 3168, section 6.1.1)
+            temp.header().ece = true;
+            temp.header().cwr = !_receiver.ackno().has_value();
+            _ecn_offered = true;
+            _sender.set_ecn(ecn_enabled());
+        }
         if (_receiver.ackno().has_value()) {
             // if the connection is already established, set the ACK flag and ackno
             temp.header().ack = true;
             temp.header().ackno = _receiver.ackno().value();
-            temp.header().win = _receiver.window_size();
+            temp.header().win = _receiver.window_field(temp.header().syn);
+            if (ecn_enabled() && !temp.header().syn) {
+                temp.header().ece = _ce_state;
+            }
+            if (sack_enabled() && !temp.header().syn && _receiver.unassembled_bytes()) {
+                // report the holes with as many blocks as the other options leave room for (each 8 bytes,
+                // after a 4-byte NOP NOP kind length prefix)
+                const size_t room = TCPHeader::MAX_OPTIONS_LENGTH - temp.header().options_length();
+                _receiver.fill_sack_blocks(temp.header(), room > 4 ? (room - 4) / 8 : 0);
+            }
+        }
+        if (temp.header().ack) {
+            // any segment carries the ACK that was being held back
+            _ack_pending = false;
+            _bytes_unacked = 0;
+            _last_ack_sent = temp.header().ackno;
         }
-        _segments_out.push(temp);
+        enable_window_scaling();
     }
     // try to see if a clean shutdown could be reached
     clean_shutdown();
@@ -28,16 +72,23 @@ void TCPConnection::unclean_shutdown() {
     _receiver.stream_out().set_error();
     _active = false;
     // the outbound should not be empty at this point
-    TCPSegment temp = _sender.segments_out().front();
+    _segments_out.push(move(_sender.segments_out().front()));
     _sender.segments_out().pop();
+    TCPSegment &temp = _segments_out.back();
     temp.header().ack = true;
     if (_receiver.ackno().has_value()) {
         // if the connection is already established, set the ackno
         temp.header().ackno = _receiver.ackno().value();
     }
     temp.header().rst = true;
-    temp.header().win = _receiver.window_size();
-    _segments_out.push(temp);
+    temp.header().win = _receiver.window_field(temp.header().syn);
+}
+
+void TCPConnection::enable_window_scaling() {
+    if (_window_scale_offered && _peer_window_scale.has_value()) {
+        _receiver.set_window_shift(_receiver.wanted_window_shift());
+        _send_window_shift = _peer_window_scale.value();
+    }
 }
 
 void TCPConnection::clean_shutdown() {
@@ -69,7 +120,31 @@ void TCPConnection::segment_received(const TCPSegment &seg) {
     if (!active()) {
         return;
     }
+    const size_t idle = _time_since_last_segment_received;
     _time_since_last_segment_received = 0;  // reset the time elapse
+    if (_cfg.header_prediction && header_predicted(seg)) {
+        return;
+    }
+    if (seg.header().syn && !_peer_window_scale.has_value() && seg.header().wscale.has_value()) {
+        _peer_window_scale = seg.header().wscale;
+        enable_window_scaling();
+    }
+    // a peer sending no MSS option is taken to accept ours
+    if (seg.header().syn && seg.header().mss.has_value()) {
+        _sender.set_peer_mss(seg.header().mss.value());
+    }
+    if (seg.header().syn && seg.header().sack_permitted) {
+        _peer_sack_permitted = true;
+    }
+    if (seg.header().syn && seg.header().ece && seg.header().cwr != seg.header().ack) {
+        // ECE and CWR on a SYN, ECE alone on a SYN/ACK
+        _peer_ecn = true;
+        _sender.set_ecn(ecn_enabled());
+    }
+    if (seg.header().syn && seg.header().timestamps.has_value() && !_receiver.ackno().has_value()) {
+        _peer_timestamps = true;
+        _ts_recent = seg.header().timestamps->tsval;
+    }
     // passive peer
     if (!_receiver.ackno().has_value() && _sender.next_seqno_absolute() == 0) {
         if (!seg.header().syn) {
@@ -103,11 +178,45 @@ void TCPConnection::segment_received(const TCPSegment &seg) {
         }
     }
     // ordinary case
+    if (timestamps_enabled() && paws_reject(seg, idle)) {
+        // a stale duplicate: drop it, but tell the peer where we are
+        if (!seg.header().rst) {
+            _sender.send_empty_segment();
+            send_sender_segments();
+        }
+        return;
+    }
+    if (timestamps_enabled() && seg.header().timestamps.has_value() &&
+        seg.header().seqno - _last_ack_sent <= 0) {
+        // the segment starts at or before what we last acknowledged, so its TSval is the one to echo
+        // (RFC 7323, section 4.3); PAWS has already made sure it is not older than TS.Recent
+        _ts_recent = seg.header().timestamps->tsval;
+    }
+    if (ecn_enabled() && seg.payload().size()) {
+        const bool ce = seg.ecn() == IPv4Header::ECN::CE;
+        if (ce != _ce_state && _ack_pending) {
+            // the data a delayed ACK is held for is acknowledged at once, with the marks it arrived with, so the
+            // peer can count marked bytes exactly (RFC 8257, section 3.2)
+            _sender.send_empty_segment();
+            send_sender_segments();
+        }
+        _ce_state = ce;
+    }
+    const bool in_order = _receiver.ackno().has_value() && seg.header().seqno == _receiver.ackno().value() &&
+                          _receiver.unassembled_bytes() == 0;
     _receiver.segment_received(seg);
-    _sender.ack_received(seg.header().ackno, seg.header().win);
-    if (_sender.stream_in().buffer_empty() && seg.length_in_sequence_space()) {
-        // no more data, but have to send a reply
-        _sender.send_empty_segment();
+    // the window in a SYN is never scaled
+    const uint8_t shift = seg.header().syn ? 0 : _send_window_shift;
+    if (sack_enabled() && seg.header().sack_count) {
+        _sender.sack_received(seg.header());
+    }
+    _sender.ack_received(seg.header().ackno,
+                         static_cast<uint64_t>(seg.header().win) << shift,
+                         seg.length_in_sequence_space() == 0,
+                         timestamp_rtt_sample(seg),
+                         ecn_enabled() && seg.header().ece && !seg.header().syn);
+    if (seg.length_in_sequence_space()) {
+        acknowledge(seg, in_order);
     }
     if (seg.header().rst) {
         _sender.send_empty_segment();
@@ -117,6 +226,105 @@ void TCPConnection::segment_received(const TCPSegment &seg) {
     send_sender_segments();
 }
 
+//! \details The prediction (RFC 1323, appendix A) is that once the handshake is over, most segments have no
+//! flags but ACK and arrive at the next sequence number expected, and either acknowledge data and carry none, or
+//! carry data and acknowledge nothing new. The first need only the sender, the second only the receiver. That
+//! holds in ESTABLISHED and in the half-closed states a bulk transfer often runs in, as neither kind of segment
+//! can end a stream. The checks come first, so a failed prediction has changed nothing.
+bool TCPConnection::header_predicted(const TCPSegment &seg) {
+    const TCPHeader &header = seg.header();
+    if (!header.ack || header.syn || header.fin || header.rst || header.urg || header.ece || header.cwr ||
+        header.sack_count || _sender.next_seqno_absolute() == _sender.bytes_in_flight() ||
+        !_receiver.ackno().has_value() || header.seqno != _receiver.ackno().value()) {
+        // the handshake isn't over, or not a plain segment in order
+        return false;
+    }
+    if (timestamps_enabled() &&
+        (!header.timestamps.has_value() || static_cast<int32_t>(header.timestamps->tsval - _ts_recent) < 0)) {
+        // PAWS may have to reject it
+        return false;
+    }
+    const uint64_t window = static_cast<uint64_t>(header.win) << _send_window_shift;
+    const size_t payload_size = seg.payload().size();
+    if (payload_size &&
+        (!_sender.ack_changes_nothing(header.ackno, window) || _receiver.unassembled_bytes() ||
+         _receiver.stream_out().input_ended() || payload_size > _receiver.window_size() ||
+         (ecn_enabled() && (_ce_state || seg.ecn() == IPv4Header::ECN::CE)))) {
+        return false;
+    }
+
+    ++_predicted_segments;
+    if (timestamps_enabled() && header.seqno - _last_ack_sent <= 0) {
+        _ts_recent = header.timestamps->tsval;
+    }
+    if (payload_size) {
+        _receiver.segment_received(seg);
+        acknowledge(seg, true);
+    } else {
+        _sender.ack_received(header.ackno, window, true, timestamp_rtt_sample(seg));
+    }
+    // an acknowledgment of our FIN may complete the shutdown
+    send_sender_segments();
+    return true;
+}
+
+//! \details Data held back by Nagle, cork, the congestion window or pacing is no reply: only a segment the
+//! sender has actually queued can carry the ACK.
+void TCPConnection::acknowledge(const TCPSegment &seg, const bool in_order) {
+    if (!_sender.segments_out().empty()) {
+        return;
+    }
+    // nothing going out, but have to send a reply, unless it can wait for more data in either direction
+    _bytes_unacked += seg.payload().size();
+    if (can_delay_ack(seg, in_order)) {
+        _ack_delay_elapsed = _ack_pending ? _ack_delay_elapsed : 0;
+        _ack_pending = true;
+    } else {
+        _sender.send_empty_segment();
+    }
+}
+
+optional<uint64_t> TCPConnection::timestamp_rtt_sample(const TCPSegment &seg) const {
+    if (!timestamps_enabled() || !seg.header().ack || !seg.header().timestamps.has_value()) {
+        return {};
+    }
+    // TSecr echoes the TSval of the segment that triggered this ACK, retransmitted or not
+    return static_cast<uint32_t>(static_cast<uint32_t>(_clock) - seg.header().timestamps->tsecr);
+}
+
+//! \details TS.Recent is forgotten after 24 days of silence, when a timestamp clock may have wrapped past it
+//! (RFC 7323, section 5.5); a RST is never rejected.
+bool TCPConnection::paws_reject(const TCPSegment &seg, const size_t idle) const {
+    static constexpr size_t PAWS_IDLE_LIMIT = 24ul * 24 * 60 * 60 * 1000;
+    if (seg.header().rst || !seg.header().timestamps.has_value() || idle > PAWS_IDLE_LIMIT) {
+        return false;
+    }
+    return static_cast<int32_t>(seg.header().timestamps->tsval - _ts_recent) < 0;
+}
+
+//! \details Anything out of order, or filling a hole, is acknowledged at once so the peer's loss recovery
+//! (and its SACK scoreboard) hears about it promptly (RFC 5681, section 4.2); so are SYN and FIN. Otherwise
+//! every second full-sized segment's worth of bytes is acknowledged at once.
+bool TCPConnection::can_delay_ack(const TCPSegment &seg, const bool in_order) const {
+    return _cfg.delayed_ack && !_quick_ack && in_order && !seg.header().syn && !seg.header().fin &&
+           _receiver.unassembled_bytes() == 0 && _bytes_unacked < 2 * _sender.mss();
+}
+
+void TCPConnection::set_quick_ack(const bool quick_ack) {
+    _quick_ack = quick_ack;
+    if (_quick_ack && _ack_pending && active()) {
+        _sender.send_empty_segment();
+        send_sender_segments();
+    }
+}
+
+void TCPConnection::set_cork(const bool corked) {
+    _sender.set_cork(corked);
+    if (active()) {
+        send_sender_segments();
+    }
+}
+
 bool TCPConnection::active() const { return _active; }
 
 size_t TCPConnection::write(const string &data) {
@@ -129,6 +337,16 @@ size_t TCPConnection::write(const string &data) {
     return written;
 }
 
+size_t TCPConnection::write(Buffer data) {
+    if (data.size() == 0) {
+        return 0;
+    }
+    size_t written = _sender.stream_in().write(move(data));
+    _sender.fill_window();  // try generate new segments
+    send_sender_segments();
+    return written;
+}
+
 //! \param[in] ms_since_last_tick number of milliseconds since the last call to this method
 void TCPConnection::tick(const size_t ms_since_last_tick) {
     if (!active()) {
@@ -136,10 +354,18 @@ void TCPConnection::tick(const size_t ms_since_last_tick) {
     }
     // let the sender tick and access the consecutive retransmission count, if too much, kill connection
     _time_since_last_segment_received += ms_since_last_tick;
+    _clock += ms_since_last_tick;
     _sender.tick(ms_since_last_tick);
     if (_sender.consecutive_retransmissions() > TCPConfig::MAX_RETX_ATTEMPTS) {
         unclean_shutdown();
     }
+    if (_ack_pending && active()) {
+        _ack_delay_elapsed += ms_since_last_tick;
+        if (_ack_delay_elapsed >= _cfg.delayed_ack_timeout && _sender.segments_out().empty()) {
+            // the delayed-ACK timer expired with nothing else going out to carry the ACK
+            _sender.send_empty_segment();
+        }
+    }
     // tick may trigger retransmission
     send_sender_segments();
 }
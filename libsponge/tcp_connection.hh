@@ -10,8 +10,8 @@
 class TCPConnection {
   private:
     TCPConfig _cfg;
-    TCPReceiver _receiver{_cfg.recv_capacity};
-    TCPSender _sender{_cfg.send_capacity, _cfg.rt_timeout, _cfg.fixed_isn};
+    TCPReceiver _receiver{_cfg.recv_capacity, _cfg.reassembler_backend};
+    TCPSender _sender{_cfg};
 
     //! outbound queue of segments that the TCPConnection wants sent
     std::queue<TCPSegment> _segments_out{};
@@ -27,6 +27,75 @@ class TCPConnection {
     //! record the last time that a segment is received, used in for linger wait
     size_t _time_since_last_segment_received{0};
 
+    //! \name Window scale negotiation (RFC 7323)
+    //!@{
+    bool _window_scale_offered{false};            //!< our SYN carried the Window Scale option
+    std::optional<uint8_t> _peer_window_scale{};  //!< the shift the peer's SYN offered, if any
+    uint8_t _send_window_shift{0};                //!< shift applied to the peer's advertised windows
+    //!@}
+
+    //! \name SACK negotiation (RFC 2018)
+    //!@{
+    bool _sack_offered{false};         //!< our SYN carried SACK-Permitted
+    bool _peer_sack_permitted{false};  //!< the peer's SYN carried SACK-Permitted
+    //!@}
+
+    //! both SYNs carried SACK-Permitted, so SACK blocks are sent and heeded
+    bool sack_enabled() const { return _sack_offered && _peer_sack_permitted; }
+
+    //! \name Timestamps (RFC 7323)
+    //!@{
+    bool _timestamps_offered{false};  //!< our SYN carried the Timestamps option
+    bool _peer_timestamps{false};     //!< the peer's SYN carried the Timestamps option
+    uint64_t _clock{0};               //!< milliseconds passed, as reported by tick(); our TSval is its low 32 bits
+    uint32_t _ts_recent{0};           //!< TS.Recent: the TSval to echo
+    WrappingInt32 _last_ack_sent{0};  //!< Last.ACK.sent: the ackno of the latest segment we sent
+    //!@}
+
+    //! both SYNs carried the Timestamps option, so every segment is timestamped
+    bool timestamps_enabled() const { return _timestamps_offered && _peer_timestamps; }
+
+    //! \name ECN (RFC 3168)
+    //!@{
+    bool _ecn_offered{false};  //!< our SYN set ECE and CWR, or our SYN/ACK set ECE in answer to such a SYN
+    bool _peer_ecn{false};     //!< the peer's SYN set ECE and CWR, or its SYN/ACK set ECE alone
+    bool _ce_state{false};     //!< the latest data segment arrived marked CE, so ACKs carry ECE (RFC 8257)
+    //!@}
+
+    //! both ends agreed to ECN, so data goes out ECN-capable and CE marks are echoed
+    bool ecn_enabled() const { return _ecn_offered && _peer_ecn; }
+
+    //! PAWS (RFC 7323, section 5.3): whether `seg` carries a timestamp older than TS.Recent, so it is a duplicate
+    //! from an earlier cycle of the sequence space; `idle` is how long nothing had arrived before it
+    bool paws_reject(const TCPSegment &seg, const size_t idle) const;
+
+    //! \name Delayed ACKs (RFC 1122)
+    //!@{
+    bool _ack_pending{false};      //!< in-order data has arrived that no outgoing segment has acknowledged yet
+    size_t _ack_delay_elapsed{0};  //!< milliseconds since the pending ACK became due
+    size_t _bytes_unacked{0};      //!< payload bytes received since the last segment we sent
+    bool _quick_ack{false};        //!< acknowledge every segment at once despite _cfg.delayed_ack
+    //!@}
+
+    //! whether the ACK for `seg` can wait: in-order data only, with room left before the next full pair of segments
+    bool can_delay_ack(const TCPSegment &seg, const bool in_order) const;
+
+    //! answer `seg`, which occupies sequence space, with an ACK now or a delayed one, unless data will carry it
+    void acknowledge(const TCPSegment &seg, const bool in_order);
+
+    //! the RTT that the timestamp echoed by `seg` measures, if timestamps are in use and it carries one
+    std::optional<uint64_t> timestamp_rtt_sample(const TCPSegment &seg) const;
+
+    //! segments handled by header prediction
+    size_t _predicted_segments{0};
+
+    //! header prediction: handle `seg` at once if it is a pure ACK or the next in-order data, after the handshake
+    //! \returns whether it was handled; if not, nothing has changed and the general path takes it
+    bool header_predicted(const TCPSegment &seg);
+
+    //! once both SYNs have carried the Window Scale option, start scaling windows in both directions
+    void enable_window_scaling();
+
     //! send all the segment in sender's outstream and add flag if necessary
     void send_sender_segments();
 
@@ -47,11 +116,26 @@ class TCPConnection {
     //! \returns the number of bytes from `data` that were actually written.
     size_t write(const std::string &data);
 
+    //! \brief Write a Buffer to the outbound byte stream without copying it
+    //! (when the configuration's send_stream_mode is ByteStream::Mode::Chunked)
+    //! \returns the number of bytes from `data` that were actually written.
+    size_t write(Buffer data);
+
     //! \returns the number of `bytes` that can be written right now.
     size_t remaining_outbound_capacity() const;
 
     //! \brief Shut down the outbound byte stream (still allows reading incoming data)
     void end_input_stream();
+
+    //! \brief Acknowledge every segment as soon as it arrives, overriding TCPConfig::delayed_ack while set
+    //! \details Meant for interactive flows, where a delayed ACK would hold up the peer's next write.
+    //! Turning it on sends any ACK that is being held back.
+    void set_quick_ack(const bool quick_ack);
+
+    //! \brief Cork the outbound stream: while set, writes only go out in full segments
+    //! \details Meant for writers that build a message from several small writes; uncorking, or ending
+    //! the stream, sends the rest at once. See also TCPConfig::no_delay.
+    void set_cork(const bool corked);
     //!@}
 
     //! \name "Output" interface for the reader
@@ -74,6 +158,22 @@ class TCPConnection {
     TCPState state() const { return {_sender, _receiver, active(), _linger_after_streams_finish}; };
     //!@}
 
+    //! \brief Milliseconds until the sender's pacing lets more data out, if any is waiting;
+    //! the owner should call tick() no later than that
+    std::optional<size_t> time_until_next_send() const { return _sender.time_until_next_send(); }
+
+    //! \brief Segments received that header prediction handled (see TCPConfig::header_prediction)
+    size_t predicted_segments() const { return _predicted_segments; }
+
+    //! \brief The segment size outgoing data is sent in (see TCPConfig::mtu_probing)
+    size_t path_mss() const { return _sender.path_mss(); }
+
+    //! \name Statistics of the peer's zero-window episodes
+    //!@{
+    size_t zero_window_episodes() const { return _sender.zero_window_episodes(); }  //!< Times its window closed
+    uint64_t zero_window_time() const { return _sender.zero_window_time(); }  //!< Milliseconds it stayed closed
+    //!@}
+
     //! \name Methods for the owner or operating system to call
     //!@{
 
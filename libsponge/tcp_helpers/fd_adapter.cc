@@ -47,7 +47,7 @@ optional<TCPSegment> TCPOverUDPSocketAdapter::read() {
 
 //! Serialize a TCP segment and send it as the payload of a UDP datagram.
 //! \param[in] seg is the TCP segment to write
-void TCPOverUDPSocketAdapter::write(TCPSegment &seg) {
+void TCPOverUDPSocketAdapter::write(TCPSegment &&seg) {
     seg.header().sport = config().source.port();
     seg.header().dport = config().destination.port();
     _sock.sendto(config().destination, seg.serialize(0));
@@ -54,8 +54,8 @@ class TCPOverUDPSocketAdapter : public FdAdapterBase {
     //! Attempts to read and return a TCP segment related to the current connection from a UDP payload
     std::optional<TCPSegment> read();
 
-    //! Writes a TCP segment into a UDP payload
-    void write(TCPSegment &seg);
+    //! Writes a TCP segment into a UDP payload, consuming it
+    void write(TCPSegment &&seg);
 
     //! Access the underlying UDP socket
     operator UDPSocket &() { return _sock; }
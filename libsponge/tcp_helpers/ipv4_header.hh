@@ -9,6 +9,15 @@ struct IPv4Header {
     static constexpr size_t LENGTH = 20;         //!< [IPv4](\ref rfc::rfc791) header length, not including options
     static constexpr uint8_t DEFAULT_TTL = 128;  //!< A reasonable default TTL value
     static constexpr uint8_t PROTO_TCP = 6;      //!< Protocol number for [tcp](\ref rfc::rfc793)
+    static constexpr size_t CKSUM_OFFSET = 10;   //!< Where the checksum sits in the serialized header
+
+    //! ECN codepoints (RFC 3168), carried in the two low bits of `tos`
+    enum class ECN : uint8_t {
+        NotECT = 0b00,  //!< the transport is not ECN-capable
+        ECT1 = 0b01,    //!< ECN-capable transport, ECT(1)
+        ECT0 = 0b10,    //!< ECN-capable transport, ECT(0)
+        CE = 0b11       //!< congestion experienced, marked by a router instead of dropping the datagram
+    };
 
     //! \struct IPv4Header
     //! ~~~{.txt}
@@ -46,6 +55,12 @@ struct IPv4Header {
     uint32_t dst = 0;           //!< dst address
     //!@}
 
+    //! \name ECN field (RFC 3168)
+    //!@{
+    ECN ecn() const { return static_cast<ECN>(tos & 0b11); }
+    void set_ecn(const ECN ecn) { tos = (tos & ~0b11) | static_cast<uint8_t>(ecn); }
+    //!@}
+
     //! Parse the IP fields from the provided NetParser
     ParseResult parse(NetParser &p);
 
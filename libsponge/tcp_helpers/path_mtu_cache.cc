@@ -0,0 +1,22 @@
+#include "path_mtu_cache.hh"
+
+using namespace std;
+
+PathMTUCache &PathMTUCache::global() {
+    static PathMTUCache cache;
+    return cache;
+}
+
+optional<size_t> PathMTUCache::lookup(const Address &destination) {
+    lock_guard<mutex> lock(_mutex);
+    const auto it = _path_mss.find(destination.ip());
+    if (it == _path_mss.end()) {
+        return {};
+    }
+    return it->second;
+}
+
+void PathMTUCache::store(const Address &destination, const size_t path_mss) {
+    lock_guard<mutex> lock(_mutex);
+    _path_mss[destination.ip()] = path_mss;
+}
@@ -0,0 +1,33 @@
+#ifndef SPONGE_LIBSPONGE_PATH_MTU_CACHE_HH
+#define SPONGE_LIBSPONGE_PATH_MTU_CACHE_HH
+
+#include "address.hh"
+
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+//! \brief The segment size each destination's path was last found to carry
+//!
+//! Filled in by connections that ran path MTU discovery (TCPConfig::mtu_probing), and read when the
+//! next connection to the same host starts, so it sends segments of that size from the first one
+//! instead of searching again. Entries are keyed by IP address, since the path does not depend on the port.
+class PathMTUCache {
+  private:
+    std::mutex _mutex{};
+    std::unordered_map<std::string, size_t> _path_mss{};
+
+  public:
+    //! \brief The cache shared by every TCPSpongeSocket in the process
+    static PathMTUCache &global();
+
+    //! \brief The segment size last stored for `destination`'s host, if any
+    std::optional<size_t> lookup(const Address &destination);
+
+    //! \brief Remember that `destination`'s host was reached with segments of `path_mss` payload bytes
+    void store(const Address &destination, const size_t path_mss);
+};
+
+#endif  // SPONGE_LIBSPONGE_PATH_MTU_CACHE_HH
@@ -2,6 +2,9 @@
 #define SPONGE_LIBSPONGE_TCP_CONFIG_HH
 
 #include "address.hh"
+#include "byte_stream.hh"
+#include "congestion_control.hh"
+#include "stream_reassembler.hh"
 #include "wrapping_integers.hh"
 
 #include <cstddef>
@@ -13,6 +16,7 @@ class TCPConfig {
   public:
     static constexpr size_t DEFAULT_CAPACITY = 64000;  //!< Default capacity
     static constexpr size_t MAX_PAYLOAD_SIZE = 1000;   //!< Conservative max payload size for real Internet
+    static constexpr size_t MAX_MSS = 65447;  //!< Largest MSS a UDP datagram fits, after a 60-byte TCP header
     static constexpr uint16_t TIMEOUT_DFLT = 1000;     //!< Default re-transmit timeout is 1 second
     static constexpr unsigned MAX_RETX_ATTEMPTS = 8;   //!< Maximum re-transmit attempts before giving up
 
@@ -20,6 +24,52 @@ class TCPConfig {
     size_t recv_capacity = DEFAULT_CAPACITY;  //!< Receive capacity, in bytes
     size_t send_capacity = DEFAULT_CAPACITY;  //!< Sender capacity, in bytes
     std::optional<WrappingInt32> fixed_isn{};
+
+    size_t mss = MAX_PAYLOAD_SIZE;  //!< Maximum segment size to advertise and send, unless the peer's is smaller
+
+    bool mtu_probing = false;            //!< Search for a larger path MTU by probing (RFC 4821)
+    size_t path_mss = MAX_PAYLOAD_SIZE;  //!< Segment size to start from with mtu_probing
+
+    bool adaptive_rto = false;     //!< Derive the retransmission timeout from measured round-trip times (RFC 6298)
+    unsigned int rto_min = 200;    //!< Lower bound of the adaptive retransmission timeout, in milliseconds
+    unsigned int rto_max = 60000;  //!< Upper bound of the adaptive retransmission timeout, in milliseconds
+
+    bool persist_backoff = false;  //!< Back off zero-window probes exponentially, up to rto_max
+
+    //! Storage of the outbound stream; ByteStream::Mode::Chunked lets written Buffers reach the payload uncopied
+    ByteStream::Mode send_stream_mode = ByteStream::Mode::Ring;
+
+    //! Where the receiver keeps out-of-order bytes
+    StreamReassembler::Backend reassembler_backend = StreamReassembler::Backend::Map;
+
+    //! Offer the Window Scale option (RFC 7323) so a recv_capacity above 64 KiB can be advertised
+    bool window_scaling = true;
+
+    bool sack = true;  //!< Offer SACK-Permitted (RFC 2018), and recover from the SACK scoreboard (RFC 6675)
+
+    bool timestamps = false;  //!< Offer the Timestamps option (RFC 7323), for RTT samples and PAWS
+
+    bool delayed_ack = false;           //!< Delay the ACK of in-order data (RFC 1122, section 4.2.3.2)
+    uint16_t delayed_ack_timeout = 40;  //!< Longest an ACK is held back, in milliseconds
+
+    //! Congestion control used by the sender; None leaves only the receiver's window in effect
+    CongestionControl::Algorithm congestion_control = CongestionControl::Algorithm::None;
+
+    bool ecn = false;  //!< Negotiate ECN (RFC 3168), and respond to the CE marks the peer echoes
+
+    bool fast_retransmit = false;  //!< Retransmit on the third duplicate ACK and recover with NewReno (RFC 6582)
+
+    bool rack = false;  //!< With fast_retransmit, detect losses by send time and probe for tail losses (RFC 8985)
+
+    bool prr = false;               //!< With fast_retransmit, send by Proportional Rate Reduction in recovery
+    bool limited_transmit = false;  //!< With fast_retransmit, send new data on the first two duplicate ACKs
+
+    bool no_delay = true;  //!< Send small segments at once (TCP_NODELAY); false applies Nagle's algorithm
+
+    bool header_prediction = true;  //!< Handle the expected next segment on a fast path (header prediction)
+
+    bool pacing = false;       //!< Release new data at a pacing rate instead of a whole window at once
+    uint64_t pacing_rate = 0;  //!< Fixed pacing rate, in bytes per second; 0 derives it from the window and SRTT
 };
 
 //! Config for classes derived from FdAdapter
@@ -1,9 +1,40 @@
 #include "tcp_header.hh"
 
+#include <algorithm>
 #include <sstream>
 
 using namespace std;
 
+//! \name TCP option kinds
+//!@{
+static constexpr uint8_t OPT_EOL = 0;             //!< End of option list
+static constexpr uint8_t OPT_NOP = 1;             //!< No-operation (padding)
+static constexpr uint8_t OPT_MSS = 2;             //!< Maximum Segment Size, RFC 793
+static constexpr uint8_t OPT_WSCALE = 3;          //!< Window Scale, RFC 7323
+static constexpr uint8_t OPT_SACK_PERMITTED = 4;  //!< SACK-Permitted, RFC 2018
+static constexpr uint8_t OPT_SACK = 5;            //!< SACK, RFC 2018
+static constexpr uint8_t OPT_TIMESTAMPS = 8;      //!< Timestamps, RFC 7323
+//!@}
+
+bool TCPHeader::SackBlock::operator==(const SackBlock &other) const {
+    return left == other.left && right == other.right;
+}
+
+bool TCPHeader::Timestamps::operator==(const Timestamps &other) const {
+    return tsval == other.tsval && tsecr == other.tsecr;
+}
+
+//! \details The layout follows the common practice of padding each option with NOPs
+//! so that multi-byte fields stay aligned; SACK-Permitted shares the Timestamps word when both are present.
+size_t TCPHeader::options_length() const {
+    size_t len = 0;
+    len += mss.has_value() ? 4 : 0;                                 // MSS
+    len += timestamps.has_value() ? 12 : (sack_permitted ? 4 : 0);  // [SACKOK|NOP NOP] TS, or NOP NOP SACKOK
+    len += wscale.has_value() ? 4 : 0;                              // NOP WS
+    len += sack_count ? 4 + 8 * sack_count : 0;                     // NOP NOP SACK
+    return len;
+}
+
 //! \param[in,out] p is a NetParser from which the TCP fields will be extracted
 //! \returns a ParseResult indicating success or the reason for failure
 //! \details It is important to check for (at least) the following potential errors
@@ -22,6 +53,8 @@ ParseResult TCPHeader::parse(NetParser &p) {
     doff = p.u8() >> 4;              // data offset
 
     const uint8_t fl_b = p.u8();                  // byte including flags
+    cwr = static_cast<bool>(fl_b & 0b1000'0000);
+    ece = static_cast<bool>(fl_b & 0b0100'0000);
     urg = static_cast<bool>(fl_b & 0b0010'0000);  // binary literals and ' digit separator since C++14!!!
     ack = static_cast<bool>(fl_b & 0b0001'0000);
     psh = static_cast<bool>(fl_b & 0b0000'1000);
@@ -33,12 +66,64 @@ ParseResult TCPHeader::parse(NetParser &p) {
     cksum = p.u16();  // checksum
     uptr = p.u16();   // urgent pointer
 
-    //    if (doff < 5) {
-    //        return ParseResult::HeaderTooShort;
-    //    }
+    if (p.error()) {
+        return p.get_error();
+    }
+
+    if (doff < 5) {
+        return ParseResult::HeaderTooShort;
+    }
+
+    // walk the options, keeping the ones we understand; a malformed option ends the walk
+    mss.reset();
+    wscale.reset();
+    sack_permitted = false;
+    sack_count = 0;
+    timestamps.reset();
+    size_t remaining = doff * 4 - TCPHeader::LENGTH;
+    while (remaining > 0 && !p.error()) {
+        const uint8_t kind = p.u8();
+        --remaining;
+        if (kind == OPT_EOL) {
+            break;
+        }
+        if (kind == OPT_NOP) {
+            continue;
+        }
+        if (remaining == 0) {
+            break;
+        }
+        const uint8_t len = p.u8();
+        --remaining;
+        if (len < 2 || size_t{len} - 2 > remaining) {
+            break;
+        }
+        const size_t body = len - 2;  // bytes after the kind and length
+        remaining -= body;
+        if (kind == OPT_MSS && body == 2) {
+            mss = p.u16();
+        } else if (kind == OPT_WSCALE && body == 1) {
+            wscale = min(p.u8(), MAX_WINDOW_SHIFT);
+        } else if (kind == OPT_SACK_PERMITTED && body == 0) {
+            sack_permitted = true;
+        } else if (kind == OPT_SACK && body > 0 && body % 8 == 0 && body / 8 <= MAX_SACK_BLOCKS) {
+            sack_count = body / 8;
+            for (uint8_t i = 0; i < sack_count; ++i) {
+                sack_blocks[i].left = WrappingInt32{p.u32()};
+                sack_blocks[i].right = WrappingInt32{p.u32()};
+            }
+        } else if (kind == OPT_TIMESTAMPS && body == 8) {
+            Timestamps ts;
+            ts.tsval = p.u32();
+            ts.tsecr = p.u32();
+            timestamps = ts;
+        } else {
+            p.remove_prefix(body);  // unknown option, or a known one with the wrong length
+        }
+    }
 
-    // skip any options or anything extra in the header
-    p.remove_prefix(doff * 4 - TCPHeader::LENGTH);
+    // skip anything left over in the header
+    p.remove_prefix(remaining);
 
     if (p.error()) {
         return p.get_error();
@@ -50,21 +135,23 @@ ParseResult TCPHeader::parse(NetParser &p) {
 //! Serialize the TCPHeader to a string (does not recompute the checksum)
 string TCPHeader::serialize() const {
     // sanity check
-    if (doff < 5) {
-        throw runtime_error("TCP header too short");
+    if (options_length() > MAX_OPTIONS_LENGTH) {
+        throw runtime_error("TCP options too long");
     }
 
+    const size_t len = length();
     string ret;
-    ret.reserve(4 * doff);
+    ret.reserve(len);
 
     NetUnparser::u16(ret, sport);              // source port
     NetUnparser::u16(ret, dport);              // destination port
     NetUnparser::u32(ret, seqno.raw_value());  // sequence number
     NetUnparser::u32(ret, ackno.raw_value());  // ack number
-    NetUnparser::u8(ret, doff << 4);           // data offset
+    NetUnparser::u8(ret, (len / 4) << 4);      // data offset
 
-    const uint8_t fl_b = (urg ? 0b0010'0000 : 0) | (ack ? 0b0001'0000 : 0) | (psh ? 0b0000'1000 : 0) |
-                         (rst ? 0b0000'0100 : 0) | (syn ? 0b0000'0010 : 0) | (fin ? 0b0000'0001 : 0);
+    const uint8_t fl_b = (cwr ? 0b1000'0000 : 0) | (ece ? 0b0100'0000 : 0) | (urg ? 0b0010'0000 : 0) |
+                         (ack ? 0b0001'0000 : 0) | (psh ? 0b0000'1000 : 0) | (rst ? 0b0000'0100 : 0) |
+                         (syn ? 0b0000'0010 : 0) | (fin ? 0b0000'0001 : 0);
     NetUnparser::u8(ret, fl_b);  // flags
     NetUnparser::u16(ret, win);  // window size
 
@@ -72,7 +159,46 @@ string TCPHeader::serialize() const {
 
     NetUnparser::u16(ret, uptr);  // urgent pointer
 
-    ret.resize(4 * doff);  // expand header to advertised size
+    // options, in the order of options_length()
+    if (mss.has_value()) {
+        NetUnparser::u8(ret, OPT_MSS);
+        NetUnparser::u8(ret, 4);
+        NetUnparser::u16(ret, mss.value());
+    }
+    if (timestamps.has_value()) {
+        if (sack_permitted) {
+            NetUnparser::u8(ret, OPT_SACK_PERMITTED);
+            NetUnparser::u8(ret, 2);
+        } else {
+            NetUnparser::u8(ret, OPT_NOP);
+            NetUnparser::u8(ret, OPT_NOP);
+        }
+        NetUnparser::u8(ret, OPT_TIMESTAMPS);
+        NetUnparser::u8(ret, 10);
+        NetUnparser::u32(ret, timestamps.value().tsval);
+        NetUnparser::u32(ret, timestamps.value().tsecr);
+    } else if (sack_permitted) {
+        NetUnparser::u8(ret, OPT_NOP);
+        NetUnparser::u8(ret, OPT_NOP);
+        NetUnparser::u8(ret, OPT_SACK_PERMITTED);
+        NetUnparser::u8(ret, 2);
+    }
+    if (wscale.has_value()) {
+        NetUnparser::u8(ret, OPT_NOP);
+        NetUnparser::u8(ret, OPT_WSCALE);
+        NetUnparser::u8(ret, 3);
+        NetUnparser::u8(ret, wscale.value());
+    }
+    if (sack_count) {
+        NetUnparser::u8(ret, OPT_NOP);
+        NetUnparser::u8(ret, OPT_NOP);
+        NetUnparser::u8(ret, OPT_SACK);
+        NetUnparser::u8(ret, 2 + 8 * sack_count);
+        for (uint8_t i = 0; i < sack_count; ++i) {
+            NetUnparser::u32(ret, sack_blocks[i].left.raw_value());
+            NetUnparser::u32(ret, sack_blocks[i].right.raw_value());
+        }
+    }
 
     return ret;
 }
@@ -85,24 +211,61 @@ string TCPHeader::to_string() const {
        << "TCP seqno: " << seqno << '\n'
        << "TCP ackno: " << ackno << '\n'
        << "TCP doff: " << +doff << '\n'
-       << "Flags: urg: " << urg << " ack: " << ack << " psh: " << psh << " rst: " << rst << " syn: " << syn
-       << " fin: " << fin << '\n'
+       << "Flags: cwr: " << cwr << " ece: " << ece << " urg: " << urg << " ack: " << ack << " psh: " << psh
+       << " rst: " << rst << " syn: " << syn << " fin: " << fin << '\n'
        << "TCP winsize: " << +win << '\n'
        << "TCP cksum: " << +cksum << '\n'
        << "TCP uptr: " << +uptr << '\n';
+    ss << dec;
+    if (mss.has_value()) {
+        ss << "TCP mss: " << mss.value() << '\n';
+    }
+    if (wscale.has_value()) {
+        ss << "TCP wscale: " << +wscale.value() << '\n';
+    }
+    if (sack_permitted) {
+        ss << "TCP sack permitted\n";
+    }
+    for (uint8_t i = 0; i < sack_count; ++i) {
+        ss << "TCP sack block: " << sack_blocks[i].left << " - " << sack_blocks[i].right << '\n';
+    }
+    if (timestamps.has_value()) {
+        ss << "TCP timestamps: " << timestamps.value().tsval << " echo " << timestamps.value().tsecr << '\n';
+    }
     return ss.str();
 }
 
 string TCPHeader::summary() const {
     stringstream ss{};
     ss << "Header(flags=" << (syn ? "S" : "") << (ack ? "A" : "") << (rst ? "R" : "") << (fin ? "F" : "")
-       << ",seqno=" << seqno << ",ack=" << ackno << ",win=" << win << ")";
+       << (ece ? "E" : "") << (cwr ? "W" : "")
+       << ",seqno=" << seqno << ",ack=" << ackno << ",win=" << win;
+    if (mss.has_value()) {
+        ss << ",mss=" << mss.value();
+    }
+    if (wscale.has_value()) {
+        ss << ",wscale=" << +wscale.value();
+    }
+    if (sack_permitted) {
+        ss << ",sackOK";
+    }
+    for (uint8_t i = 0; i < sack_count; ++i) {
+        ss << ",sack=" << sack_blocks[i].left << "-" << sack_blocks[i].right;
+    }
+    if (timestamps.has_value()) {
+        ss << ",ts=" << timestamps.value().tsval << "/" << timestamps.value().tsecr;
+    }
+    ss << ")";
     return ss.str();
 }
 
 bool TCPHeader::operator==(const TCPHeader &other) const {
     // TODO(aozdemir) more complete check (right now we omit cksum, src, dst
-    return seqno == other.seqno && ackno == other.ackno && doff == other.doff && urg == other.urg && ack == other.ack &&
-           psh == other.psh && rst == other.rst && syn == other.syn && fin == other.fin && win == other.win &&
-           uptr == other.uptr;
+    // doff is omitted too: serialize() derives it from length(), i.e. from the options compared here
+    return seqno == other.seqno && ackno == other.ackno && cwr == other.cwr && ece == other.ece && urg == other.urg &&
+           ack == other.ack && psh == other.psh && rst == other.rst && syn == other.syn && fin == other.fin &&
+           win == other.win && uptr == other.uptr && mss == other.mss && wscale == other.wscale &&
+           sack_permitted == other.sack_permitted && sack_count == other.sack_count &&
+           equal(sack_blocks.begin(), sack_blocks.begin() + sack_count, other.sack_blocks.begin()) &&
+           timestamps == other.timestamps;
 }
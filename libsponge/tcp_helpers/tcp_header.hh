@@ -4,10 +4,34 @@
 #include "parser.hh"
 #include "wrapping_integers.hh"
 
+#include <array>
+#include <optional>
+
 //! \brief [TCP](\ref rfc::rfc793) segment header
-//! \note TCP options are not supported
+//! \note The options understood are MSS, Window Scale, SACK-Permitted, SACK and Timestamps;
+//! any other option is skipped when parsing and dropped when serializing.
 struct TCPHeader {
-    static constexpr size_t LENGTH = 20;  //!< [TCP](\ref rfc::rfc793) header length, not including options
+    static constexpr size_t LENGTH = 20;              //!< [TCP](\ref rfc::rfc793) header length, not including options
+    static constexpr size_t MAX_OPTIONS_LENGTH = 40;  //!< Room for options left by the 4-bit `doff`
+    static constexpr uint8_t MAX_WINDOW_SHIFT = 14;   //!< Largest window scale shift allowed by RFC 7323
+    static constexpr size_t MAX_SACK_BLOCKS = 4;      //!< Most SACK blocks that fit in the options (RFC 2018)
+    static constexpr size_t CKSUM_OFFSET = 16;        //!< Where the checksum sits in the serialized header
+
+    //! A SACK block: the peer holds the sequence numbers [left, right)
+    struct SackBlock {
+        WrappingInt32 left{0};   //!< first sequence number of the block
+        WrappingInt32 right{0};  //!< sequence number just past the block
+
+        bool operator==(const SackBlock &other) const;
+    };
+
+    //! The Timestamps option (RFC 7323)
+    struct Timestamps {
+        uint32_t tsval = 0;  //!< sender's timestamp clock when the segment was sent
+        uint32_t tsecr = 0;  //!< most recent tsval received from the peer (valid when `ack` is set)
+
+        bool operator==(const Timestamps &other) const;
+    };
 
     //! \struct TCPHeader
     //! ~~~{.txt}
@@ -20,9 +44,9 @@ struct TCPHeader {
     //!  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
     //!  |                    Acknowledgment Number                      |
     //!  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-    //!  |  Data |           |U|A|P|R|S|F|                               |
-    //!  | Offset| Reserved  |R|C|S|S|Y|I|            Window             |
-    //!  |       |           |G|K|H|T|N|N|                               |
+    //!  |  Data |       |C|E|U|A|P|R|S|F|                               |
+    //!  | Offset| Rsrvd |W|C|R|C|S|S|Y|I|            Window             |
+    //!  |       |       |R|E|G|K|H|T|N|N|                               |
     //!  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
     //!  |           Checksum            |         Urgent Pointer        |
     //!  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -39,6 +63,8 @@ struct TCPHeader {
     WrappingInt32 seqno{0};     //!< sequence number
     WrappingInt32 ackno{0};     //!< ack number
     uint8_t doff = LENGTH / 4;  //!< data offset
+    bool cwr = false;           //!< congestion window reduced flag (RFC 3168)
+    bool ece = false;           //!< ECN-echo flag (RFC 3168)
     bool urg = false;           //!< urgent flag
     bool ack = false;           //!< ack flag
     bool psh = false;           //!< push flag
@@ -50,10 +76,28 @@ struct TCPHeader {
     uint16_t uptr = 0;          //!< urgent pointer
     //!@}
 
+    //! \name TCP options
+    //! Held in place, so a header never allocates; set a field to send the option.
+    //!@{
+    std::optional<uint16_t> mss{};                         //!< Maximum Segment Size (RFC 793), SYN only
+    std::optional<uint8_t> wscale{};                       //!< Window Scale shift count (RFC 7323), SYN only
+    bool sack_permitted = false;                           //!< SACK-Permitted (RFC 2018), SYN only
+    std::array<SackBlock, MAX_SACK_BLOCKS> sack_blocks{};  //!< SACK blocks (RFC 2018); the first `sack_count` hold
+    uint8_t sack_count = 0;                                //!< number of valid entries in `sack_blocks`
+    std::optional<Timestamps> timestamps{};                //!< Timestamps (RFC 7323)
+    //!@}
+
+    //! Length of the options this header serializes, including padding to a multiple of 4 bytes
+    size_t options_length() const;
+
+    //! Length of the serialized header; serialize() writes `doff` as length() / 4
+    size_t length() const { return LENGTH + options_length(); }
+
     //! Parse the TCP fields from the provided NetParser
     ParseResult parse(NetParser &p);
 
     //! Serialize the TCP fields
+    //! \throws std::runtime_error if the options don't fit in MAX_OPTIONS_LENGTH bytes
     std::string serialize() const;
 
     //! Return a string containing a header in human-readable format
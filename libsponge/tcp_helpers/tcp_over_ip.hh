@@ -13,7 +13,8 @@ class TCPOverIPv4Adapter : public FdAdapterBase {
   public:
     std::optional<TCPSegment> unwrap_tcp_in_ip(const InternetDatagram &ip_dgram);
 
-    InternetDatagram wrap_tcp_in_ip(TCPSegment &seg);
+    //! Wrap `seg` in an IPv4 datagram, consuming it
+    InternetDatagram wrap_tcp_in_ip(TCPSegment &&seg);
 };
 
 #endif  // SPONGE_LIBSPONGE_TCP_OVER_IP_HH
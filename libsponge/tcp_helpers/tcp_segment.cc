@@ -27,18 +27,21 @@ size_t TCPSegment::length_in_sequence_space() const {
 }
 
 //! \param[in] datagram_layer_checksum pseudo-checksum from the lower-layer protocol
+//! \details The header is serialized once, with a zero checksum that is then filled in place.
 BufferList TCPSegment::serialize(const uint32_t datagram_layer_checksum) const {
     TCPHeader header_out = _header;
     header_out.cksum = 0;
+    string header_serialized = header_out.serialize();
 
     // calculate checksum -- taken over entire segment
     InternetChecksum check(datagram_layer_checksum);
-    check.add(header_out.serialize());
+    check.add(header_serialized);
     check.add(_payload);
-    header_out.cksum = check.value();
+    const uint16_t cksum = check.value();
+    header_serialized[TCPHeader::CKSUM_OFFSET] = cksum >> 8;
+    header_serialized[TCPHeader::CKSUM_OFFSET + 1] = cksum & 0xff;
 
-    BufferList ret;
-    ret.append(header_out.serialize());
+    BufferList ret{move(header_serialized)};
     ret.append(_payload);
 
     return ret;
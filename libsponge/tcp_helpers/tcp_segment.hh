@@ -2,6 +2,7 @@
 #define SPONGE_LIBSPONGE_TCP_SEGMENT_HH
 
 #include "buffer.hh"
+#include "ipv4_header.hh"
 #include "tcp_header.hh"
 
 #include <cstdint>
@@ -11,6 +12,7 @@ class TCPSegment {
   private:
     TCPHeader _header{};
     Buffer _payload{};
+    IPv4Header::ECN _ecn{IPv4Header::ECN::NotECT};
 
   public:
     //! \brief Parse the segment from a string
@@ -26,6 +28,10 @@ class TCPSegment {
 
     const Buffer &payload() const { return _payload; }
     Buffer &payload() { return _payload; }
+
+    //! ECN codepoint of the datagram that carried the segment, or is to carry it; not part of its serialization
+    IPv4Header::ECN ecn() const { return _ecn; }
+    IPv4Header::ECN &ecn() { return _ecn; }
     //!@}
 
     //! \brief Segment's length in sequence space
@@ -1,9 +1,11 @@
 #include "tcp_sponge_socket.hh"
 
 #include "parser.hh"
+#include "path_mtu_cache.hh"
 #include "tun.hh"
 #include "util.hh"
 
+#include <algorithm>
 #include <cstddef>
 #include <exception>
 #include <iostream>
@@ -24,7 +26,10 @@ template <typename AdaptT>
 void TCPSpongeSocket<AdaptT>::_tcp_loop(const function<bool()> &condition) {
     auto base_time = timestamp_ms();
     while (condition()) {
-        auto ret = _eventloop.wait_next_event(TCP_TICK_MS);
+        // wake early when paced data is due before the next regular tick
+        const size_t pacing_wait =
+            _tcp.has_value() ? _tcp.value().time_until_next_send().value_or(TCP_TICK_MS) : TCP_TICK_MS;
+        auto ret = _eventloop.wait_next_event(min(TCP_TICK_MS, pacing_wait));
         if (ret == EventLoop::Result::Exit or _abort) {
             break;
         }
@@ -52,6 +57,7 @@ TCPSpongeSocket<AdaptT>::TCPSpongeSocket(pair<FileDescriptor, FileDescriptor> da
 template <typename AdaptT>
 void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
     _tcp.emplace(config);
+    _mtu_probing = config.mtu_probing;
 
     // Set up the event loop
 
@@ -95,9 +101,9 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
         _thread_data,
         Direction::In,
         [&] {
-            const auto data = _thread_data.read(_tcp->remaining_outbound_capacity());
+            auto data = _thread_data.read(_tcp->remaining_outbound_capacity());
             const auto len = data.size();
-            const auto amount_written = _tcp->write(move(data));
+            const auto amount_written = _tcp->write(Buffer{move(data)});
             if (amount_written != len) {
                 throw runtime_error("TCPConnection::write() accepted less than advertised length");
             }
@@ -154,7 +160,7 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
                         Direction::Out,
                         [&] {
                             while (not _tcp->segments_out().empty()) {
-                                _datagram_adapter.write(_tcp->segments_out().front());
+                                _datagram_adapter.write(move(_tcp->segments_out().front()));
                                 _tcp->segments_out().pop();
                             }
                         },
@@ -207,7 +213,12 @@ void TCPSpongeSocket<AdaptT>::connect(const TCPConfig &c_tcp, const FdAdapterCon
         throw runtime_error("connect() with TCPConnection already initialized");
     }
 
-    _initialize_TCP(c_tcp);
+    // start from the segment size this host was last reached with
+    TCPConfig config = c_tcp;
+    if (config.mtu_probing) {
+        config.path_mss = PathMTUCache::global().lookup(c_ad.destination).value_or(config.path_mss);
+    }
+    _initialize_TCP(config);
 
     _datagram_adapter.config_mut() = c_ad;
 
@@ -258,10 +269,18 @@ void TCPSpongeSocket<AdaptT>::_tcp_main() {
         }
         _tcp_loop([] { return true; });
         shutdown(SHUT_RDWR);
+        if (_mtu_probing) {
+            PathMTUCache::global().store(_datagram_adapter.config().destination, _tcp.value().path_mss());
+        }
         if (not _tcp.value().active()) {
             cerr << "DEBUG: TCP connection finished "
                  << (_tcp.value().state() == TCPState::State::RESET ? "uncleanly" : "cleanly.\n");
         }
+        if (_tcp.value().zero_window_episodes() > 0) {
+            cerr << "DEBUG: Peer's window was closed " << _tcp.value().zero_window_episodes() << " time"
+                 << (_tcp.value().zero_window_episodes() == 1 ? "" : "s") << ", for "
+                 << _tcp.value().zero_window_time() << " ms in all.\n";
+        }
         _tcp.reset();
     } catch (const exception &e) {
         cerr << "Exception in TCPConnection runner thread: " << e.what() << "\n";
@@ -55,6 +55,8 @@ class TCPSpongeSocket : public LocalStreamSocket {
 
     bool _fully_acked{false};  //!< Has the outbound data been fully acknowledged by the peer?
 
+    bool _mtu_probing{false};  //!< Does the TCPConnection run path MTU discovery, to be remembered in PathMTUCache?
+
   public:
     //! Construct from the interface that the TCPConnection thread will use to read and write datagrams
     explicit TCPSpongeSocket(AdaptT &&datagram_interface);
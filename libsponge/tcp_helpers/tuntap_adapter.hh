@@ -26,8 +26,8 @@ class TCPOverIPv4OverTunFdAdapter : public TCPOverIPv4Adapter {
         return unwrap_tcp_in_ip(ip_dgram);
     }
 
-    //! Creates an IPv4 datagram from a TCP segment and writes it to the TUN device
-    void write(TCPSegment &seg) { _tun.write(wrap_tcp_in_ip(seg).serialize()); }
+    //! Creates an IPv4 datagram from a TCP segment, consuming it, and writes it to the TUN device
+    void write(TCPSegment &&seg) { _tun.write(wrap_tcp_in_ip(std::move(seg)).serialize()); }
 
     //! Access the underlying TUN device
     operator TunFD &() { return _tun; }
@@ -1,5 +1,9 @@
 #include "tcp_receiver.hh"
 
+#include <algorithm>
+#include <array>
+#include <limits>
+
 using namespace std;
 
 void TCPReceiver::segment_received(const TCPSegment &seg) {
@@ -32,8 +36,10 @@ void TCPReceiver::segment_received(const TCPSegment &seg) {
         setFIN(abs_seqno + seg.length_in_sequence_space());
     }
 
-    string payload_string = payload.copy();
-    _reassembler.push_substring(payload_string, stream_idx, header.fin);
+    if (payload.size()) {
+        _last_payload_index = stream_idx;
+    }
+    _reassembler.push_substring(payload, stream_idx, header.fin);
 }
 
 uint64_t TCPReceiver::abs_ackno() const {
@@ -55,3 +61,37 @@ optional<WrappingInt32> TCPReceiver::ackno() const {
 }
 
 size_t TCPReceiver::window_size() const { return _reassembler.window_size(); }
+
+uint16_t TCPReceiver::window_field(const bool syn) const {
+    const size_t window = syn ? window_size() : window_size() >> _window_shift;
+    return min<size_t>(window, numeric_limits<uint16_t>::max());
+}
+
+uint8_t TCPReceiver::wanted_window_shift() const {
+    uint8_t shift = 0;
+    while (shift < TCPHeader::MAX_WINDOW_SHIFT && (_capacity >> shift) > numeric_limits<uint16_t>::max()) {
+        ++shift;
+    }
+    return shift;
+}
+
+//! \param[out] header receives the blocks in `sack_blocks` and their number in `sack_count`
+//! \param[in] max_blocks is how many blocks fit alongside the header's other options
+void TCPReceiver::fill_sack_blocks(TCPHeader &header, const size_t max_blocks) const {
+    header.sack_count = 0;
+    if (!seenSYN() || max_blocks == 0 || _reassembler.empty()) {
+        return;
+    }
+    // one range more than can be sent, in case the most recent one is moved to the front from past the end
+    array<StreamReassembler::Range, TCPHeader::MAX_SACK_BLOCKS + 1> ranges;
+    const size_t held = _reassembler.held_ranges(ranges.data(), min(max_blocks, TCPHeader::MAX_SACK_BLOCKS) + 1);
+    const auto recent = find_if(ranges.begin(), ranges.begin() + held, [&](const StreamReassembler::Range &range) {
+        return range.begin <= _last_payload_index && _last_payload_index < range.end;
+    });
+    rotate(ranges.begin(), recent, recent + (recent != ranges.begin() + held));
+    // stream index i has absolute sequence number i + 1
+    header.sack_count = min({held, max_blocks, TCPHeader::MAX_SACK_BLOCKS});
+    for (uint8_t i = 0; i < header.sack_count; ++i) {
+        header.sack_blocks[i] = {wrap(ranges[i].begin + 1, _isn.value()), wrap(ranges[i].end + 1, _isn.value())};
+    }
+}
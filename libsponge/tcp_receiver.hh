@@ -24,13 +24,21 @@ class TCPReceiver {
     bool _FIN;
     std::optional<WrappingInt32> _isn;
 
+    //! The window scale shift applied to advertised windows, once negotiated
+    uint8_t _window_shift{0};
+
+    //! Stream index of the first byte of the most recent segment carrying payload
+    uint64_t _last_payload_index{0};
+
   public:
     //! \brief Construct a TCP receiver
     //!
     //! \param capacity the maximum number of bytes that the receiver will
     //!                 store in its buffers at any give time.
-    TCPReceiver(const size_t capacity)
-        : _reassembler(capacity), _capacity(capacity), _abs_fin(0), _SYN(false), _FIN(false), _isn({}) {}
+    //! \param backend where the reassembler keeps out-of-order bytes
+    TCPReceiver(const size_t capacity,
+                const StreamReassembler::Backend backend = StreamReassembler::Backend::Map)
+        : _reassembler(capacity, backend), _capacity(capacity), _abs_fin(0), _SYN(false), _FIN(false), _isn({}) {}
 
     //! \name Accessors to provide feedback to the remote TCPSender
     //!@{
@@ -54,6 +62,29 @@ class TCPReceiver {
     //! accepted by the receiver) and (b) the sequence number of the
     //! beginning of the window (the ackno).
     size_t window_size() const;
+
+    //! \brief The value for the 16-bit window field of an outgoing segment
+    //! \details window_size() shifted right by the negotiated scale (never for a SYN, per RFC 7323),
+    //! clamped to 65535.
+    uint16_t window_field(const bool syn) const;
+    //!@}
+
+    //! \name Window scaling (RFC 7323)
+    //!@{
+
+    //! \brief The smallest shift that lets the full capacity be advertised, to offer in our SYN
+    uint8_t wanted_window_shift() const;
+
+    //! \brief Start scaling advertised windows by `shift` (both SYNs carried the option)
+    void set_window_shift(const uint8_t shift) { _window_shift = shift; }
+    //!@}
+
+    //! \name Selective acknowledgment (RFC 2018)
+    //!@{
+
+    //! \brief Describe the bytes held out of order as SACK blocks in `header`, at most `max_blocks` of them
+    //! \details The block holding the most recently received segment comes first, the others follow lowest first.
+    void fill_sack_blocks(TCPHeader &header, const size_t max_blocks) const;
     //!@}
 
     //! \brief number of bytes stored but not yet reassembled
@@ -2,19 +2,36 @@
 
 #include "tcp_config.hh"
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
 #include <random>
+#include <utility>
+#include <vector>
 
 using namespace std;
 //! \param[in] capacity the capacity of the outgoing byte stream
 //! \param[in] retx_timeout the initial amount of time to wait before retransmitting the oldest outstanding segment
 //! \param[in] fixed_isn the Initial Sequence Number to use, if set (otherwise uses a random ISN)
 TCPSender::TCPSender(const size_t capacity, const uint16_t retx_timeout, const std::optional<WrappingInt32> fixed_isn)
-    : _isn(fixed_isn.value_or(WrappingInt32{random_device()()}))
-    , _initial_retransmission_timeout{retx_timeout}
-    , _stream(capacity)
+    : TCPSender([&] {
+        TCPConfig cfg;
+        cfg.send_capacity = capacity;
+        cfg.rt_timeout = retx_timeout;
+        cfg.fixed_isn = fixed_isn;
+        return cfg;
+    }()) {}
+
+//! \param[in] cfg the connection's configuration
+//!                (send_capacity, rt_timeout, fixed_isn, send_stream_mode, congestion_control,
+//!                adaptive_rto, rto_min, rto_max, persist_backoff, fast_retransmit, prr, limited_transmit, rack,
+//!                pacing, pacing_rate, no_delay, mss, mtu_probing and path_mss are used)
+TCPSender::TCPSender(const TCPConfig &cfg)
+    : _isn(cfg.fixed_isn.value_or(WrappingInt32{random_device()()}))
+    , _initial_retransmission_timeout{cfg.rt_timeout}
+    , _stream(cfg.send_capacity, cfg.send_stream_mode)
     , _latest_ack_seqno(0)
-    , _current_retransmission_timeout{retx_timeout}
+    , _current_retransmission_timeout{cfg.rt_timeout}
     , _is_timer_on(false)
     , _syn_sent(false)
     , _fin_sent(false)
@@ -23,11 +40,83 @@ TCPSender::TCPSender(const size_t capacity, const uint16_t retx_timeout, const s
     , _consecutive_retransmission(0)
     , _bytes_in_flight(0)
     , _receiver_window_size(0)
-    , _receiver_freespace(0) {}
+    , _receiver_freespace(0)
+    , _mss(clamp<size_t>(cfg.mss, 1, TCPConfig::MAX_MSS))
+    , _cc(CongestionControl::make(cfg.congestion_control,
+                                  cfg.mtu_probing ? clamp<size_t>(cfg.path_mss, 1, _mss) : _mss))
+    , _rtt(cfg.rt_timeout, cfg.rto_min, cfg.rto_max)
+    , _adaptive_rto(cfg.adaptive_rto)
+    , _max_rto(cfg.rto_max)
+    , _fast_retransmit(cfg.fast_retransmit)
+    , _prr(cfg.prr && cfg.fast_retransmit && _cc)
+    , _limited_transmit(cfg.limited_transmit && cfg.fast_retransmit)
+    , _rack(cfg.rack && cfg.fast_retransmit ? optional<RackTlp>{in_place} : nullopt)
+    , _mtu_probing(cfg.mtu_probing)
+    , _path_mss(_mtu_probing ? clamp<size_t>(cfg.path_mss, 1, _mss) : _mss)
+    , _probe_ceiling(_mss + 1)
+    , _pacing(cfg.pacing || cfg.congestion_control == CongestionControl::Algorithm::BBR)
+    , _pacing_rate(cfg.pacing_rate)
+    , _persist_backoff(cfg.persist_backoff)
+    , _nagle(!cfg.no_delay) {}
 
 size_t TCPSender::bytes_in_flight() const { return _bytes_in_flight; }
 
-void TCPSender::_send_segment(TCPSegment &seg) {
+size_t TCPSender::congestion_window() const { return _cc ? _cc->cwnd() : numeric_limits<size_t>::max(); }
+
+size_t TCPSender::slow_start_threshold() const { return _cc ? _cc->ssthresh() : numeric_limits<size_t>::max(); }
+
+uint64_t TCPSender::zero_window_time() const {
+    return _zero_window_ms + (_zero_window_since.has_value() ? _clock - *_zero_window_since : 0);
+}
+
+uint64_t TCPSender::_send_allowance() const {
+    if (!_cc) {
+        return _receiver_freespace;
+    }
+    if (_prr && _in_recovery) {
+        return min(_receiver_freespace, _prr_sndcnt);
+    }
+    uint64_t cwnd = _cc->cwnd();
+    if (_limited_transmit && !_in_recovery) {
+        // each of the first two duplicate ACKs lets a segment past cwnd (RFC 3042)
+        cwnd += min(_duplicate_acks, 2u) * _path_mss;
+    }
+    // in SACK recovery the pipe estimate stands in for the flight size (RFC 6675, section 5)
+    const uint64_t in_network = _in_recovery && _sack_recovery ? _scoreboard.pipe() : _bytes_in_flight;
+    return min(_receiver_freespace, cwnd > in_network ? cwnd - in_network : 0);
+}
+
+//! \details Without a fixed pacing_rate, the rate is BBR's model rate once it has one; otherwise it is the
+//! congestion window (the receiver's window without congestion control) per SRTT, so nothing is paced before
+//! the first RTT sample.
+//! BBR is always paced, since it steers by the delivery rate it measures rather than by loss.
+uint64_t TCPSender::_pacing_interval(const size_t length) const {
+    if (_pacing_rate) {
+        return length * 1000000 / _pacing_rate;
+    }
+    if (const optional<uint64_t> model_rate = _cc ? _cc->pacing_rate() : nullopt; model_rate.has_value()) {
+        return length * 1000000 / *model_rate;
+    }
+    const optional<double> srtt = _rtt.smoothed_rtt();
+    const double window = _cc ? _cc->cwnd() : _receiver_window_size;
+    if (!srtt.has_value() || srtt.value() <= 0 || window <= 0) {
+        return 0;
+    }
+    // pace ahead of the window in slow start so it can still double every round trip
+    const double gain = _cc && _cc->cwnd() < _cc->ssthresh() ? 2.0 : 1.2;
+    return static_cast<uint64_t>(length * srtt.value() * 1000 / (gain * window));
+}
+
+optional<size_t> TCPSender::time_until_next_send() const {
+    if (!_pacing_deferred) {
+        return {};
+    }
+    const uint64_t now_us = _clock * 1000;
+    return _next_send_us > now_us ? (_next_send_us - now_us + 999) / 1000 : 0;
+}
+
+void TCPSender::_send_segment(TCPSegment &&seg) {
+    const uint64_t abs_seqno = _next_seqno;
     seg.header().seqno = next_seqno();
     _next_seqno += seg.length_in_sequence_space();
     _bytes_in_flight += seg.length_in_sequence_space();
@@ -39,8 +128,27 @@ void TCPSender::_send_segment(TCPSegment &seg) {
     if (_syn_sent) {
         _receiver_freespace -= seg.length_in_sequence_space();
     }
-    _segments_out.push(seg);
-    _outstanding_segment.push(seg);
+    if (_in_recovery && _sack_recovery) {
+        _scoreboard.sent(seg.length_in_sequence_space());
+    }
+    if (_prr && _in_recovery) {
+        _prr_sent(seg.length_in_sequence_space());
+    }
+    if (_limited_transmit && _cc && !_in_recovery && _bytes_in_flight > _cc->cwnd()) {
+        _limited_sent += min<uint64_t>(seg.length_in_sequence_space(), _bytes_in_flight - _cc->cwnd());
+    }
+    if (_outstanding_segment.empty()) {
+        _rate.restart(_clock);
+    }
+    _outstanding_segment.push_back({seg.payload(), seg.header().syn, seg.header().fin, _clock, _clock, abs_seqno});
+    if (_ecn && !seg.header().syn && _receiver_window_size) {
+        // only new data is ECN-capable: not the SYN, retransmissions or zero-window probes (RFC 3168, section 6.1)
+        seg.ecn() = IPv4Header::ECN::ECT0;
+        seg.header().cwr = exchange(_send_cwr, false);
+    }
+    _segments_out.push(move(seg));
+    _outstanding_segment.back().delivery = _rate.snapshot(_clock);
+    _arm_pto();
 }
 
 void TCPSender::fill_window() {
@@ -49,10 +157,10 @@ void TCPSender::fill_window() {
         _syn_sent = true;
         TCPSegment seg;
         seg.header().syn = true;
-        _send_segment(seg);
+        _send_segment(move(seg));
         return;
     }
-    if (!_outstanding_segment.empty() && _outstanding_segment.front().header().syn) {
+    if (!_outstanding_segment.empty() && _outstanding_segment.front().syn) {
         // syn already sent but not acknowledged yet
         return;
     }
@@ -62,24 +170,49 @@ void TCPSender::fill_window() {
     }
     if (!_stream.input_ended() && _stream.buffer_size() == 0) {
         // currently no more data to be send out, but input stream has not ended
+        _mark_app_limited();
         return;
     }
     // branches: last announced window_size is zero or non-zero
     // if non-zero, try to fill the window. When eof reached, if possible, feed FIN(occupy 1 placeholder seqno)
     // if zero, if freespace is 0, send tester-segment (fin or 1-byte depending on if stream eof reached)
     if (_receiver_window_size) {
-        while (_receiver_freespace) {
+        const bool backlog = _pacing_deferred;
+        _pacing_deferred = false;
+        while (const uint64_t allowance = _send_allowance()) {
+            if (_pacing && _next_send_us > _clock * 1000) {
+                // tick() sends the rest once the pacing clock catches up
+                _pacing_deferred = true;
+                break;
+            }
             TCPSegment seg;
-            size_t next_read =
-                min({_stream.buffer_size(), static_cast<size_t>(_receiver_freespace), TCPConfig::MAX_PAYLOAD_SIZE});
-            seg.payload() = Buffer{_stream.read(next_read)};
-            if (_stream.eof() && _receiver_freespace > next_read) {
+            size_t next_read = min({_stream.buffer_size(), static_cast<size_t>(allowance), _path_mss});
+            if (_hold_small_segment(next_read)) {
+                break;
+            }
+            const size_t probe_size = (_path_mss + _probe_ceiling) / 2;
+            const bool probe = _mtu_probing && !_probe_seqno.has_value() && !_in_recovery &&
+                               _probe_ceiling - _path_mss > PROBE_RESOLUTION && _stream.buffer_size() > probe_size &&
+                               allowance >= probe_size;
+            if (probe) {
+                // the probe is full of data, so nothing is lost if it isn't the size that gets through
+                next_read = probe_size;
+                _probe_seqno = _next_seqno;
+                _probe_size = probe_size;
+            }
+            seg.payload() = _stream.read_buffer(next_read);
+            if (_stream.eof() && allowance > next_read) {
                 // have space for the FIN flag
                 seg.header().fin = true;
                 _fin_sent = true;
             }
-            _send_segment(seg);
+            if (_pacing) {
+                const uint64_t earliest_us = (backlog ? _previous_tick_clock : _clock) * 1000;
+                _next_send_us = max(_next_send_us, earliest_us) + _pacing_interval(seg.length_in_sequence_space());
+            }
+            _send_segment(move(seg));
             if (_stream.buffer_empty()) {
+                _mark_app_limited();
                 break;
             }
         }
@@ -91,60 +224,491 @@ void TCPSender::fill_window() {
                 // send FIN flag
                 seg.header().fin = true;
                 _fin_sent = true;
-                _send_segment(seg);
             } else if (!_stream.buffer_empty()) {
                 // send 1 byte tester
-                seg.payload() = Buffer{_stream.read(1)};
-                _send_segment(seg);
+                seg.payload() = _stream.read_buffer(1);
+            }
+            if (seg.length_in_sequence_space()) {
+                _send_segment(move(seg));
+                // the persist timer, not the retransmission timer, resends it while the window stays closed
+                _persist_interval = _current_retransmission_timeout;
+                _persist_deadline = _clock + _persist_interval;
+            }
+        }
+    }
+}
+
+//! \details Only a short tail of the stream is held: a segment cut short by the window is sent as usual,
+//! and so is the last one once the stream has ended.
+bool TCPSender::_hold_small_segment(const size_t size) const {
+    if (size >= _path_mss || size < _stream.buffer_size() || _stream.input_ended()) {
+        return false;
+    }
+    return _corked || (_nagle && _bytes_in_flight > 0);
+}
+
+void TCPSender::set_cork(const bool corked) {
+    _corked = corked;
+    if (!_corked && _syn_sent) {
+        fill_window();
+    }
+}
+
+void TCPSender::_probe_delivered() {
+    _path_mss = _probe_size;
+    _probe_seqno.reset();
+}
+
+//! \details The pieces stand for the probe in the scoreboard: they are sent only as retransmissions,
+//! and never timed (Karn).
+void TCPSender::_probe_lost() {
+    auto it = partition_point(
+        _outstanding_segment.begin(), _outstanding_segment.end(), [&](const OutstandingSegment &outstanding) {
+            return outstanding.abs_seqno < *_probe_seqno;
+        });
+    const OutstandingSegment probe = move(*it);
+    vector<OutstandingSegment> pieces;
+    for (size_t offset = 0; offset < _probe_size; offset += _path_mss) {
+        Buffer piece = probe.payload.substr(offset, min(_path_mss, _probe_size - offset));
+        pieces.push_back({move(piece), false, false, probe.sent_at, probe.xmit_ts, probe.abs_seqno + offset, true});
+        pieces.back().lost = probe.lost;
+        pieces.back().delivery = probe.delivery;
+    }
+    it = _outstanding_segment.erase(it);
+    _outstanding_segment.insert(it, pieces.begin(), pieces.end());
+    _probe_ceiling = _probe_size;
+    _probe_seqno.reset();
+}
+
+void TCPSender::_retransmit(OutstandingSegment &outstanding) {
+    TCPSegment seg;
+    seg.header().seqno = wrap(outstanding.abs_seqno, _isn);
+    seg.header().syn = outstanding.syn;
+    seg.header().fin = outstanding.fin;
+    seg.payload() = outstanding.payload;
+    _segments_out.push(move(seg));
+    outstanding.retransmitted = true;
+    outstanding.xmit_ts = _clock;
+    outstanding.delivery = _rate.snapshot(_clock);
+    if (_prr && _in_recovery) {
+        _prr_sent(outstanding.length_in_sequence_space());
+    }
+}
+
+void TCPSender::_retransmit_oldest() {
+    if (_probe_seqno == _outstanding_segment.front().abs_seqno) {
+        _probe_lost();
+    }
+    _retransmit(_outstanding_segment.front());
+}
+
+void TCPSender::_enter_recovery(const uint64_t delivered) {
+    _in_recovery = true;
+    _recover = _next_seqno;
+    _sack_recovery = _scoreboard.sacked_bytes() > 0;
+    if (_rack) {
+        _rack->disarm_pto();
+    }
+    if (_cc) {
+        _cc->enter_recovery(_bytes_in_flight - min(_bytes_in_flight, _limited_sent), _clock, _sack_recovery);
+    }
+    _limited_sent = 0;
+    for (OutstandingSegment &outstanding : _outstanding_segment) {
+        outstanding.rescued = false;
+    }
+    if (_prr) {
+        _prr_delivered = 0;
+        _prr_out = 0;
+        _recover_fs = _bytes_in_flight;
+        if (_sack_recovery) {
+            _update_pipe();
+        }
+        _prr_on_ack(delivered);
+    }
+    if (!_sack_recovery) {
+        _retransmit_oldest();
+        return;
+    }
+    if (!_rack || _outstanding_segment.front().lost) {
+        // the oldest segment is retransmitted whatever the window (RFC 6675, section 5, step 4.2)
+        _retransmit_oldest();
+        _outstanding_segment.front().rescued = true;
+    }
+    _rescue_lost();
+}
+
+size_t TCPSender::_update_pipe() {
+    size_t lost = _rack ? 0 : _lost_prefix();
+    if (_probe_seqno.has_value()) {
+        const size_t probe = partition_point(_outstanding_segment.begin(),
+                                             _outstanding_segment.end(),
+                                             [&](const OutstandingSegment &outstanding) {
+                                                 return outstanding.abs_seqno < *_probe_seqno;
+                                             }) -
+                             _outstanding_segment.begin();
+        if (probe < _outstanding_segment.size() && SackScoreboard::deemed_lost(_outstanding_segment, probe, lost)) {
+            _probe_lost();
+            lost = _rack ? 0 : _lost_prefix();
+        }
+    }
+    _scoreboard.update_pipe(_outstanding_segment, lost);
+    return lost;
+}
+
+//! \details A rescue is only sent while pipe stays below cwnd, or with PRR while sndcnt lasts.
+//! With RACK, the segments it marked stand in for the DupThresh prefix; they need not form a prefix,
+//! so then every segment is examined.
+void TCPSender::_rescue_lost() {
+    const size_t lost = _update_pipe();
+    const size_t scan_end = _rack ? _outstanding_segment.size() : lost;
+    for (size_t i = 0; i < scan_end; ++i) {
+        OutstandingSegment &outstanding = _outstanding_segment[i];
+        if (!SackScoreboard::deemed_lost(_outstanding_segment, i, lost) || outstanding.rescued) {
+            continue;
+        }
+        if (_prr ? _prr_sndcnt == 0 : _cc && _scoreboard.pipe() >= _cc->cwnd()) {
+            break;
+        }
+        _retransmit(outstanding);
+        outstanding.rescued = true;
+        _scoreboard.sent(outstanding.length_in_sequence_space());
+    }
+}
+
+//! \details While pipe exceeds ssthresh, sending keeps to the proportion ssthresh / RecoverFS of the data
+//! delivered; below it, the slow start reduction bound lets out at most what was delivered plus one MSS per
+//! acknowledgment, until pipe is back at ssthresh (RFC 6937, section 3). Without SACK, pipe is estimated as
+//! the flight size less a segment per duplicate ACK.
+void TCPSender::_prr_on_ack(const uint64_t delivered) {
+    _prr_delivered += delivered;
+    const uint64_t dup_acked = min<uint64_t>(_bytes_in_flight, _duplicate_acks * _path_mss);
+    const uint64_t pipe = _sack_recovery ? _scoreboard.pipe() : _bytes_in_flight - dup_acked;
+    const uint64_t ssthresh = _cc->ssthresh();
+    uint64_t sndcnt = 0;
+    if (pipe > ssthresh) {
+        const uint64_t target = (_prr_delivered * ssthresh + _recover_fs - 1) / max<uint64_t>(_recover_fs, 1);
+        sndcnt = target > _prr_out ? target - _prr_out : 0;
+    } else {
+        const uint64_t limit = max(_prr_delivered > _prr_out ? _prr_delivered - _prr_out : 0, delivered) + _path_mss;
+        sndcnt = min(ssthresh - pipe, limit);
+    }
+    // whole segments only: what rounding up overshoots, prr_out takes back from later acknowledgments
+    _prr_sndcnt = (sndcnt + _path_mss - 1) / _path_mss * _path_mss;
+}
+
+void TCPSender::_prr_sent(const uint64_t length) {
+    _prr_out += length;
+    _prr_sndcnt -= min(_prr_sndcnt, length);
+}
+
+bool TCPSender::_rack_detect_loss() {
+    return _rack->detect_loss(_outstanding_segment, _clock, _rtt.smoothed_rtt(), _in_recovery || _lost_prefix() > 0);
+}
+
+//! \details No probe is wanted during recovery, with the window closed, or before the handshake completes.
+void TCPSender::_arm_pto() {
+    if (!_rack) {
+        return;
+    }
+    if (_in_recovery || !_is_timer_on || !_receiver_window_size || _outstanding_segment.empty() ||
+        _outstanding_segment.front().syn) {
+        _rack->disarm_pto();
+        return;
+    }
+    const optional<uint64_t> rto_left = _current_retransmission_timeout > _last_tick_time
+                                            ? optional<uint64_t>{_current_retransmission_timeout - _last_tick_time}
+                                            : nullopt;
+    _rack->arm_pto(_outstanding_segment, _clock, _rtt.smoothed_rtt(), _initial_retransmission_timeout, rto_left);
+}
+
+//! \details New data goes out if the receiver's window has room, whatever the congestion window
+//! (RFC 8985, section 7.3); the retransmission timer restarts from the probe.
+void TCPSender::_send_loss_probe() {
+    if (!_stream.buffer_empty() && _receiver_freespace > 0) {
+        TCPSegment seg;
+        seg.payload() =
+            _stream.read_buffer(min({_stream.buffer_size(), static_cast<size_t>(_receiver_freespace), _path_mss}));
+        if (_stream.eof() && _receiver_freespace > seg.payload().size()) {
+            seg.header().fin = true;
+            _fin_sent = true;
+        }
+        _rack->probe_sent(_next_seqno + seg.length_in_sequence_space(), false);
+        _send_segment(move(seg));
+    } else {
+        if (_probe_seqno == _outstanding_segment.back().abs_seqno) {
+            // a probe for the path MTU at the tail gets no ACK: take it as too large
+            _probe_lost();
+        }
+        _rack->probe_sent(_next_seqno, true);
+        _retransmit(_outstanding_segment.back());
+    }
+    _last_tick_time = 0;
+}
+
+void TCPSender::_mark_app_limited() {
+    if (_cc && _bytes_in_flight < _cc->cwnd()) {
+        _rate.mark_app_limited(_bytes_in_flight);
+    }
+}
+
+void TCPSender::set_peer_mss(const size_t mss) {
+    if (mss == 0 || mss >= _mss) {
+        return;
+    }
+    _mss = mss;
+    _probe_ceiling = min(_probe_ceiling, _mss + 1);
+    if (_path_mss > _mss) {
+        _path_mss = _mss;
+        if (_cc) {
+            _cc->set_mss(_path_mss);
+        }
+    }
+}
+
+//! \param header is the header of the received segment, whose `sack_blocks` are examined
+//! \details Blocks that don't fall within the outstanding data (such as D-SACKs below the ackno) are ignored.
+void TCPSender::sack_received(const TCPHeader &header) {
+    if (_outstanding_segment.empty()) {
+        return;
+    }
+    for (uint8_t i = 0; i < header.sack_count; ++i) {
+        const uint64_t left = unwrap(header.sack_blocks[i].left, _isn, _next_seqno);
+        const uint64_t right = unwrap(header.sack_blocks[i].right, _isn, _next_seqno);
+        if (left >= right || right > _next_seqno) {
+            continue;
+        }
+        _scoreboard.mark(_outstanding_segment, left, right, [&](const OutstandingSegment &outstanding) {
+            _rate.delivered(outstanding, _clock);
+            if (_rack) {
+                _rack->delivered(outstanding, _clock);
+            }
+            if (_probe_seqno == outstanding.abs_seqno) {
+                _probe_delivered();
+            }
+        });
+    }
+}
+
+//! \param abs_ackno the absolute ackno
+//! \param duplicate whether the acknowledgment is a duplicate ACK
+//! \param popped whether it acknowledged new data
+//! \param bytes_acked the payload it newly acknowledged
+//! \param newly_acked the sequence space it newly acknowledged that was not SACKed before
+//! \param newly_sacked the sequence space SACKed since the previous acknowledgment
+bool TCPSender::_recovery_on_ack(const uint64_t abs_ackno,
+                                 const bool duplicate,
+                                 const bool popped,
+                                 const uint64_t bytes_acked,
+                                 const uint64_t newly_acked,
+                                 const uint64_t newly_sacked) {
+    const unsigned previous_duplicates = _duplicate_acks;
+    _duplicate_acks = duplicate ? _duplicate_acks + 1 : 0;
+    _limited_sent = _duplicate_acks ? _limited_sent : 0;
+    const bool rack_lost = _rack && _rack_detect_loss();
+    // DeliveredData (RFC 6937): what this acknowledgment newly covers, cumulatively or selectively; without
+    // SACK each duplicate stands for a segment, which the next cumulative acknowledgment takes back
+    uint64_t delivered = newly_acked + newly_sacked;
+    if (_in_recovery ? !_sack_recovery : !_scoreboard.sacked_bytes() && !newly_sacked) {
+        const uint64_t counted = previous_duplicates * _path_mss;
+        delivered = duplicate ? _path_mss : newly_acked - min(newly_acked, counted);
+    }
+    if (_prr && _in_recovery && !(popped && abs_ackno >= _recover)) {
+        if (_sack_recovery) {
+            _update_pipe();
+        }
+        _prr_on_ack(delivered);
+    }
+    if (_in_recovery && popped) {
+        if (abs_ackno >= _recover) {
+            // full acknowledgment: everything outstanding at entry has arrived
+            _in_recovery = false;
+            if (_cc) {
+                _cc->exit_recovery(_bytes_in_flight);
+            }
+            _arm_pto();
+        } else if (_sack_recovery) {
+            // the scoreboard knows which holes remain
+            _rescue_lost();
+        } else {
+            // partial acknowledgment: the new oldest segment was lost too
+            _retransmit_oldest();
+            if (_cc) {
+                _cc->on_partial_ack(bytes_acked);
             }
         }
+        return true;
     }
+    if (_in_recovery && _sack_recovery) {
+        _rescue_lost();
+    } else if (_in_recovery && duplicate && _cc) {
+        _cc->on_duplicate_ack();
+    } else if (!_in_recovery && abs_ackno >= _recover &&
+               // with SACK, enough data SACKed above the oldest segment marks it lost without waiting for
+               // three duplicates (RFC 6675, section 5); RACK goes by send times instead, and only falls
+               // back on duplicates when nothing is SACKed
+               (_rack ? rack_lost || (_duplicate_acks == 3 && !_scoreboard.sacked_bytes())
+                      : _duplicate_acks == 3 || (_scoreboard.sacked_bytes() && _lost_prefix() > 0))) {
+        _enter_recovery(delivered);
+    }
+    return false;
 }
 
 //! \param ackno The remote receiver's ackno (acknowledgment number)
 //! \param window_size The remote receiver's advertised window size
-void TCPSender::ack_received(const WrappingInt32 ackno, const uint16_t window_size) {
+//! \param pure_ack Whether the ackno arrived on a segment that occupies no sequence space
+//! \param rtt_sample The RTT measured by the Timestamps option, if the segment carried one
+//! \param ece Whether the peer echoed a congestion experienced mark
+void TCPSender::ack_received(const WrappingInt32 ackno,
+                             const uint64_t window_size,
+                             const bool pure_ack,
+                             const optional<uint64_t> rtt_sample,
+                             const bool ece) {
     uint64_t abs_ackno = unwrap(ackno, _isn, _next_seqno);
     if (!valid_ackno(abs_ackno)) {
         // invalid acknowledge number
         return;
     }
 
+    // a duplicate ACK (RFC 5681, section 2) acknowledges nothing new, with data still outstanding,
+    // and leaves the window unchanged
+    const bool duplicate = pure_ack && !_outstanding_segment.empty() &&
+                           abs_ackno == _outstanding_segment.front().abs_seqno &&
+                           window_size == _receiver_window_size;
     _receiver_window_size = window_size;
     _receiver_freespace = window_size;
+    if (window_size == 0 && !_zero_window_since.has_value()) {
+        _zero_window_since = _clock;
+        ++_zero_window_episodes;
+    } else if (window_size > 0 && _zero_window_since.has_value()) {
+        _zero_window_ms += _clock - *_zero_window_since;
+        _zero_window_since.reset();
+    }
+    uint64_t bytes_acked = 0;
+    uint64_t newly_acked = 0;  // sequence space acknowledged here and not SACKed before
+    const uint64_t newly_sacked = _scoreboard.take_newly_sacked();
+    bool popped = false;
+    bool timeable = true;  // Karn: no sample if any acknowledged segment was retransmitted
+    uint64_t newest_sent_at = 0;
     // try to pop out fully-acknowledged segment
     while (!_outstanding_segment.empty()) {
-        uint64_t outstanding_abs_seq_begin = unwrap(_outstanding_segment.front().header().seqno, _isn, _next_seqno);
-        uint64_t outstanding_seq_len = _outstanding_segment.front().length_in_sequence_space();
+        const OutstandingSegment &outstanding = _outstanding_segment.front();
+        uint64_t outstanding_abs_seq_begin = outstanding.abs_seqno;
+        uint64_t outstanding_seq_len = outstanding.length_in_sequence_space();
         if (outstanding_abs_seq_begin + outstanding_seq_len <= abs_ackno) {
-            TCPSegment seg = _outstanding_segment.front();
             // a success pop out
-            _bytes_in_flight -= seg.length_in_sequence_space();
-            _outstanding_segment.pop();
-            // reset RTO
-            _current_retransmission_timeout = _initial_retransmission_timeout;
-            // if any remaining outstanding, reset the timer
-            _last_tick_time = 0;
-            // refresh the consecutive retrans back to 0
-            _consecutive_retransmission = 0;
+            _bytes_in_flight -= outstanding_seq_len;
+            bytes_acked += outstanding.payload.size();
+            _scoreboard.acknowledged(outstanding);
+            newly_acked += outstanding.sacked ? 0 : outstanding_seq_len;
+            timeable = timeable && !outstanding.retransmitted;
+            newest_sent_at = outstanding.sent_at;
+            if (_probe_seqno == outstanding.abs_seqno) {
+                _probe_delivered();
+            }
+            if (!outstanding.sacked) {
+                _rate.delivered(outstanding, _clock);
+            }
+            if (_rack && !outstanding.sacked) {
+                _rack->delivered(outstanding, _clock);
+            }
+            popped = true;
+            _outstanding_segment.pop_front();
         } else {
             break;
         }
     }
+    if (popped) {
+        if (rtt_sample.has_value()) {
+            _rtt.add_sample(rtt_sample.value());
+        } else if (timeable) {
+            _rtt.add_sample(_clock - newest_sent_at);
+        }
+        // reset RTO
+        _current_retransmission_timeout = _adaptive_rto ? _rtt.rto() : _initial_retransmission_timeout;
+        // if any remaining outstanding, reset the timer
+        _last_tick_time = 0;
+        // refresh the consecutive retrans back to 0
+        _consecutive_retransmission = 0;
+    }
 
     if (!_outstanding_segment.empty()) {
         _receiver_freespace = abs_ackno + window_size -
-                              unwrap(_outstanding_segment.front().header().seqno, _isn, _next_seqno) - _bytes_in_flight;
+                              _outstanding_segment.front().abs_seqno -
+                              _bytes_in_flight;
     }
     if (!_bytes_in_flight) {
         // all sent acknowledged so far, close the timer
         _is_timer_on = false;
     }
+    if (const optional<RateSample> sample = _rate.take_sample(rtt_sample, _bytes_in_flight, _clock); sample && _cc) {
+        _cc->on_rate_sample(*sample);
+    }
+    if (_persist_deadline.has_value()) {
+        // the peer answered, so unanswered probes start counting over
+        _consecutive_retransmission = 0;
+        if (window_size > 0 || popped) {
+            // the window opened, or the probe got in: a probe still outstanding is left to the RTO
+            _persist_deadline.reset();
+            _last_tick_time = 0;
+        }
+    }
+    if (_rack && _rack->probe_acknowledged(abs_ackno) && _cc) {
+        // the probe repaired a loss
+        _cc->on_loss(_bytes_in_flight, _clock);
+        _cc->exit_recovery(_bytes_in_flight);
+    }
+    if (popped) {
+        _arm_pto();
+    }
+    if (_fast_retransmit && _recovery_on_ack(abs_ackno, duplicate, popped, bytes_acked, newly_acked, newly_sacked)) {
+        fill_window();
+        return;
+    }
+    if (_cc && bytes_acked) {
+        // only payload counts towards window growth, not SYN or FIN
+        _cc->on_ack({bytes_acked, _bytes_in_flight, _clock, ece});
+    }
+    if (_cc && ece && !_in_recovery && abs_ackno >= _recover && abs_ackno > _ecn_recover) {
+        // a router marked the data instead of dropping it: reduce once for this window of data
+        _cc->on_ecn_echo(_bytes_in_flight, _clock);
+        _ecn_recover = _next_seqno;
+        _send_cwr = true;
+    }
     fill_window();
 }
 
 //! \param[in] ms_since_last_tick the number of milliseconds since the last call to this method
 void TCPSender::tick(const size_t ms_since_last_tick) {
+    _previous_tick_clock = _clock;
+    _clock += ms_since_last_tick;
+    if (_pacing_deferred && _next_send_us <= _clock * 1000) {
+        fill_window();
+    }
+    if (_persist_deadline.has_value()) {
+        // the retransmission timer waits while the window is closed
+        if (*_persist_deadline <= _clock) {
+            _retransmit(_outstanding_segment.front());
+            // an unanswered probe counts towards giving up, whatever the interval
+            ++_consecutive_retransmission;
+            if (_persist_backoff) {
+                _persist_interval = min<uint64_t>(2 * _persist_interval, _max_rto);
+            }
+            _persist_deadline = _clock + _persist_interval;
+        }
+        return;
+    }
+    if (_rack && _rack->reordering_timer_expired(_clock) && _rack_detect_loss()) {
+        // a reordering window ran out with no ACK to notice
+        if (_in_recovery && _sack_recovery) {
+            _rescue_lost();
+        } else if (!_in_recovery && _outstanding_segment.front().abs_seqno >= _recover) {
+            _enter_recovery(0);
+        }
+    }
+    if (_rack && _rack->pto_expired(_clock)) {
+        _send_loss_probe();
+        return;
+    }
     if (!_is_timer_on) {
         // timer currently not available
         return;
@@ -154,10 +718,26 @@ void TCPSender::tick(const size_t ms_since_last_tick) {
         // not yet expired
         return;
     } else {
-        _segments_out.push(_outstanding_segment.front());
-        if (_receiver_window_size || _outstanding_segment.front().header().syn) {
+        _retransmit_oldest();
+        if (_receiver_window_size || _outstanding_segment.front().syn) {
             ++_consecutive_retransmission;
             _current_retransmission_timeout *= 2;
+            if (_adaptive_rto) {
+                _current_retransmission_timeout = min(_current_retransmission_timeout, _max_rto);
+            }
+            if (_cc) {
+                // a timeout is a congestion signal; a zero-window probe going unanswered is not
+                _cc->on_timeout(_bytes_in_flight, _clock);
+            }
+            // the timeout ends any fast recovery, and duplicate ACKs for data sent so far start none
+            _in_recovery = false;
+            _duplicate_acks = 0;
+            _recover = _next_seqno;
+            // the receiver may renege on SACKed data, so the scoreboard starts over (RFC 2018, section 8)
+            _scoreboard.reset(_outstanding_segment);
+            if (_rack) {
+                _rack->reset(_outstanding_segment);
+            }
         }
         _last_tick_time = 0;  // reset the clock
     }
@@ -169,5 +749,5 @@ void TCPSender::send_empty_segment() {
     // no retransmission for empty segment
     TCPSegment seg;
     seg.header().seqno = next_seqno();
-    _segments_out.push(seg);
+    _segments_out.push(move(seg));
 }
@@ -2,6 +2,12 @@
 #define SPONGE_LIBSPONGE_TCP_SENDER_HH
 
 #include "byte_stream.hh"
+#include "congestion_control.hh"
+#include "delivery_rate.hh"
+#include "outstanding_segment.hh"
+#include "rack_tlp.hh"
+#include "rtt_estimator.hh"
+#include "sack_scoreboard.hh"
 #include "tcp_config.hh"
 #include "tcp_segment.hh"
 #include "wrapping_integers.hh"
@@ -51,22 +57,241 @@ class TCPSender {
     //! last tick's timestamp
     size_t _last_tick_time;
 
-    //! the outstanding segment sent but not acknowledged
-    std::queue<TCPSegment> _outstanding_segment;
+    //! the outstanding segment sent but not acknowledged, oldest first
+    OutstandingSegments _outstanding_segment;
 
     //! the number of consecutive retransmission before any acknowledge
     unsigned int _consecutive_retransmission;
 
     //！ bytes currently sent but not acknowledged
-    uint16_t _bytes_in_flight;
+    uint64_t _bytes_in_flight;
 
-    //! the latest window size of the receiver
-    uint16_t _receiver_window_size;
+    //! the latest window size of the receiver, in bytes (already scaled)
+    uint64_t _receiver_window_size;
 
     //! the current remaining receiver free space the sender perceive
     uint64_t _receiver_freespace;
 
-    void _send_segment(TCPSegment &seg);
+    //! the largest payload to send: the configured MSS, or the peer's if smaller
+    size_t _mss;
+
+    //! the congestion control algorithm, empty if disabled
+    CongestionController _cc;
+
+    //! milliseconds passed since the sender was constructed, as reported by tick()
+    uint64_t _clock{0};
+
+    //! SRTT/RTTVAR estimate from acknowledged segments
+    RTTEstimator _rtt;
+
+    //! take the RTO from _rtt instead of resetting to _initial_retransmission_timeout
+    bool _adaptive_rto;
+
+    //! upper bound for the backed-off RTO when _adaptive_rto is set
+    unsigned int _max_rto;
+
+    //! retransmit on the third duplicate ACK instead of waiting for the timer
+    bool _fast_retransmit;
+
+    //! duplicate ACKs received in a row
+    unsigned int _duplicate_acks{0};
+
+    //! in fast recovery, until everything outstanding at entry has been acknowledged
+    bool _in_recovery{false};
+
+    //! absolute seqno ending the data outstanding when recovery was last entered or the timer last expired;
+    //! no new recovery begins until it is acknowledged (RFC 6582, section 3.2)
+    uint64_t _recover{0};
+
+    //! \name SACK-based loss recovery (RFC 6675)
+    //!@{
+
+    //! the `sacked` marks on the outstanding segments, and the pipe estimate
+    SackScoreboard _scoreboard{};
+
+    //! the current recovery is driven by the scoreboard rather than by partial ACKs
+    bool _sack_recovery{false};
+
+    //! how many of the oldest outstanding segments the scoreboard deems lost, with DupThresh counted in _path_mss
+    size_t _lost_prefix() const { return _scoreboard.lost_prefix(_outstanding_segment, _path_mss); }
+
+    //! recompute the scoreboard's pipe, first splitting the path MTU probe if it is deemed lost;
+    //! returns the scoreboard's lost_prefix() (0 with RACK, whose marks are kept per segment)
+    size_t _update_pipe();
+
+    //! recompute pipe, then retransmit lost segments not yet rescued, oldest first, while the window allows
+    void _rescue_lost();
+    //!@}
+
+    //! \name Proportional Rate Reduction (RFC 6937)
+    //!@{
+
+    //! PRR governs what is sent during fast recovery, instead of the congestion window
+    bool _prr;
+
+    uint64_t _prr_delivered{0};  //!< prr_delivered: bytes the receiver reported delivered since recovery began
+    uint64_t _prr_out{0};        //!< prr_out: bytes sent since recovery began
+    uint64_t _recover_fs{0};     //!< RecoverFS: the flight size when recovery began
+    uint64_t _prr_sndcnt{0};     //!< sndcnt: bytes the latest acknowledgment lets out, in whole segments
+
+    //! an acknowledgment during recovery reported `delivered` bytes delivered: work out _prr_sndcnt
+    void _prr_on_ack(const uint64_t delivered);
+
+    //! count `length` bytes sent during recovery against _prr_sndcnt
+    void _prr_sent(const uint64_t length);
+    //!@}
+
+    //! let the first two duplicate ACKs each send a segment past the congestion window (RFC 3042)
+    bool _limited_transmit;
+
+    //! bytes Limited Transmit has sent past the congestion window since the last new acknowledgment; they are
+    //! left out of the flight size that ssthresh is computed from (RFC 5681, section 3.2, step 2)
+    uint64_t _limited_sent{0};
+
+    //! \name RACK-TLP loss detection (RFC 8985)
+    //!@{
+
+    //! deems segments lost by when they were sent rather than by duplicate ACKs, and probes for tail losses;
+    //! empty if disabled
+    std::optional<RackTlp> _rack;
+
+    //! let RACK mark the segments it deems lost; returns whether any awaits retransmission
+    bool _rack_detect_loss();
+
+    //! restart the probe timeout (PTO) after new data was sent or acknowledged, or stop it if no probe is wanted
+    void _arm_pto();
+
+    //! the PTO expired: send a segment of new data, or else resend the last segment, to elicit an ACK
+    void _send_loss_probe();
+    //!@}
+
+    //! delivery rate samples for the congestion control (draft-cheng-iccrg-delivery-rate-estimation)
+    DeliveryRateEstimator _rate{};
+
+    //! the stream ran dry with room left in the congestion window: the rate samples now understate the path
+    void _mark_app_limited();
+
+    //! \name Path MTU discovery (RFC 4821)
+    //!@{
+
+    //! the search stops once the sizes neither known to get through nor known not to are fewer than this
+    static constexpr size_t PROBE_RESOLUTION = 32;
+
+    //! probe for a larger segment size than _path_mss
+    bool _mtu_probing;
+
+    //! the largest segment size known to get through, in which new data is sent; _mss without probing
+    size_t _path_mss;
+
+    //! the smallest segment size known not to get through, or one past _mss
+    size_t _probe_ceiling;
+
+    //! absolute seqno of the probe in flight, if any
+    std::optional<uint64_t> _probe_seqno{};
+
+    //! payload size of the probe in flight
+    size_t _probe_size{0};
+
+    //! the probe arrived: its size becomes the path's
+    void _probe_delivered();
+
+    //! the probe must be retransmitted: lower the ceiling and split it into _path_mss pieces, to be resent instead
+    void _probe_lost();
+    //!@}
+
+    //! \name Pacing
+    //!@{
+
+    //! release new segments no faster than the pacing rate
+    bool _pacing;
+
+    //! fixed pacing rate in bytes per second, 0 to derive it from the window and SRTT
+    uint64_t _pacing_rate;
+
+    //! the sender's clock, in microseconds, before which no new segment is released
+    uint64_t _next_send_us{0};
+
+    //! the clock at the previous tick: a backlog released by tick() earns credit back to it at most, and data
+    //! written after an idle spell earns none, so neither goes out in a burst
+    uint64_t _previous_tick_clock{0};
+
+    //! fill_window() stopped with data still waiting for the pacing clock
+    bool _pacing_deferred{false};
+
+    //! microseconds the pacing rate spreads `length` bytes over, 0 while there is no rate
+    uint64_t _pacing_interval(const size_t length) const;
+    //!@}
+
+    //! \name Persist timer (RFC 9293, section 3.8.6.1)
+    //!@{
+
+    //! double the interval between zero-window probes, up to _max_rto, instead of probing every RTO
+    bool _persist_backoff;
+
+    //! when the zero-window probe is next resent, while the peer's window is closed
+    std::optional<uint64_t> _persist_deadline{};
+
+    //! the interval the next zero-window probe waits, in milliseconds
+    uint64_t _persist_interval{0};
+
+    //! when the peer's window closed, if it is closed
+    std::optional<uint64_t> _zero_window_since{};
+
+    //! milliseconds spent with a closed window, over the episodes that have ended
+    uint64_t _zero_window_ms{0};
+
+    //! how many times the peer's window has closed
+    size_t _zero_window_episodes{0};
+    //!@}
+
+    //! \name ECN (RFC 3168)
+    //!@{
+
+    //! the connection negotiated ECN: new data goes out ECN-capable, and echoed marks are responded to
+    bool _ecn{false};
+
+    //! absolute seqno ending the data outstanding at the last response to an ECN echo; further echoes are
+    //! ignored until it is acknowledged
+    uint64_t _ecn_recover{0};
+
+    //! set CWR on the next segment of new data, to tell the peer the window was reduced
+    bool _send_cwr{false};
+    //!@}
+
+    //! hold a less-than-full segment while data is unacknowledged (Nagle's algorithm)
+    bool _nagle;
+
+    //! hold every less-than-full segment until uncorked
+    bool _corked{false};
+
+    //! whether a segment of `size` payload bytes, less than the stream holds or a full segment, should wait
+    //! for more data instead of going out now
+    bool _hold_small_segment(const size_t size) const;
+
+    //! resend `outstanding`, noting the time of this transmission
+    void _retransmit(OutstandingSegment &outstanding);
+
+    //! resend the oldest outstanding segment ahead of the timer
+    void _retransmit_oldest();
+
+    //! start fast recovery at the first lost segment, on an acknowledgment that reported `delivered` bytes
+    //! delivered
+    void _enter_recovery(const uint64_t delivered);
+
+    //! count duplicate ACKs, enter fast recovery on a loss, and during recovery retransmit what the
+    //! acknowledgment shows lost; returns whether it acknowledged new data during recovery, which grows no window
+    bool _recovery_on_ack(const uint64_t abs_ackno,
+                          const bool duplicate,
+                          const bool popped,
+                          const uint64_t bytes_acked,
+                          const uint64_t newly_acked,
+                          const uint64_t newly_sacked);
+
+    //! number `seg` and send it, keeping it as outstanding; the payload is shared, not copied
+    void _send_segment(TCPSegment &&seg);
+
+    //! how many more bytes the receiver's window and the congestion window both allow to be sent
+    uint64_t _send_allowance() const;
 
   public:
     //! Initialize a TCPSender
@@ -74,6 +299,9 @@ class TCPSender {
               const uint16_t retx_timeout = TCPConfig::TIMEOUT_DFLT,
               const std::optional<WrappingInt32> fixed_isn = {});
 
+    //! Initialize a TCPSender from a connection's configuration
+    explicit TCPSender(const TCPConfig &cfg);
+
     //! \name "Input" interface for the writer
     //!@{
     ByteStream &stream_in() { return _stream; }
@@ -84,7 +312,24 @@ class TCPSender {
     //!@{
 
     //! \brief A new acknowledgment was received
-    void ack_received(const WrappingInt32 ackno, const uint16_t window_size);
+    //! \note `window_size` is in bytes, i.e. already scaled if window scaling is in use
+    //! \param pure_ack whether the acknowledgment came on a segment without payload, SYN or FIN;
+    //!                 only those can count as duplicate ACKs
+    //! \param rtt_sample the round-trip time the acknowledgment's echoed timestamp measures, in milliseconds;
+    //!                   used instead of timing the acknowledged segments, and even if they were retransmitted
+    //! \param ece whether the acknowledgment carried ECN-Echo, with ECN negotiated
+    void ack_received(const WrappingInt32 ackno,
+                      const uint64_t window_size,
+                      const bool pure_ack = true,
+                      const std::optional<uint64_t> rtt_sample = {},
+                      const bool ece = false);
+
+    //! \brief The peer's SYN advertised an MSS of `mss`; segments are sized to it if it is smaller than ours
+    void set_peer_mss(const size_t mss);
+
+    //! \brief SACK blocks were received; call before ack_received() for the same segment
+    //! \details Marks the outstanding segments the blocks cover, for recovery to skip.
+    void sack_received(const TCPHeader &header);
 
     //! \brief Generate an empty-payload segment (useful for creating empty ACK segments)
     void send_empty_segment();
@@ -94,6 +339,12 @@ class TCPSender {
 
     //! \brief Notifies the TCPSender of the passage of time
     void tick(const size_t ms_since_last_tick);
+
+    //! \brief While corked, only full segments are sent; uncorking sends what was held back
+    void set_cork(const bool corked);
+
+    //! \brief ECN was negotiated: mark new data ECN-capable from now on
+    void set_ecn(const bool enabled) { _ecn = enabled; }
     //!@}
 
     //! \name Accessors
@@ -107,6 +358,49 @@ class TCPSender {
     //! \brief Number of consecutive retransmissions that have occurred in a row
     unsigned int consecutive_retransmissions() const;
 
+    //! \brief Smoothed round-trip time, in milliseconds (empty until a segment has been timed)
+    std::optional<double> estimated_rtt() const { return _rtt.smoothed_rtt(); }
+
+    //! \brief Retransmission timeout the timer is currently running with, in milliseconds
+    unsigned int retransmission_timeout() const { return _current_retransmission_timeout; }
+
+    //! \brief Whether the sender is in fast recovery
+    bool in_fast_recovery() const { return _in_recovery; }
+
+    //! \brief Whether an acknowledgment of `ackno` advertising `window_size` would tell the sender nothing:
+    //! everything sent is acknowledged already, and the window is open and unchanged (see header prediction)
+    bool ack_changes_nothing(const WrappingInt32 ackno, const uint64_t window_size) const {
+        return _bytes_in_flight == 0 && !_persist_deadline.has_value() && window_size > 0 &&
+               window_size == _receiver_window_size && ackno == next_seqno();
+    }
+
+    //! \brief Sequence space of the outstanding segments the receiver has SACKed
+    size_t sacked_bytes() const { return _scoreboard.sacked_bytes(); }
+
+    //! \brief Milliseconds until paced data can next be sent (empty if nothing is waiting on pacing),
+    //! so the owner can tick the sender in time
+    std::optional<size_t> time_until_next_send() const;
+
+    //! \brief The largest payload the sender puts in a segment
+    size_t mss() const { return _mss; }
+
+    //! \name Statistics of zero-window episodes
+    //!@{
+    size_t zero_window_episodes() const { return _zero_window_episodes; }  //!< Times the peer's window closed
+    //! Milliseconds the peer's window has been closed, the current episode included
+    uint64_t zero_window_time() const;
+    //!@}
+
+    //! \brief The segment size new data is sent in: mss(), or with path MTU discovery the largest size
+    //! known to get through (probes aside)
+    size_t path_mss() const { return _path_mss; }
+
+    //! \brief Congestion window, in bytes (the maximum value of size_t without congestion control)
+    size_t congestion_window() const;
+
+    //! \brief Slow-start threshold, in bytes (the maximum value of size_t without congestion control)
+    size_t slow_start_threshold() const;
+
     //! \brief TCPSegments that the TCPSender has enqueued for transmission.
     //! \note These must be dequeued and sent by the TCPConnection,
     //! which will need to fill in the fields that are set by the TCPReceiver
@@ -133,7 +427,7 @@ class TCPSender {
             return abs_ack_seqno <= _next_seqno;
         }
         return abs_ack_seqno <= _next_seqno &&
-               abs_ack_seqno >= unwrap(_outstanding_segment.front().header().seqno, _isn, _next_seqno);
+               abs_ack_seqno >= _outstanding_segment.front().abs_seqno;
     }
 };
 
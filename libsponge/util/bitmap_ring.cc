@@ -0,0 +1,105 @@
+#include "bitmap_ring.hh"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+static constexpr size_t WORD_BITS = 64;
+
+//! \param[in] capacity is the number of bytes the ring can hold
+BitmapRing::BitmapRing(const size_t capacity)
+    : _bytes(capacity), _occupied((capacity + WORD_BITS - 1) / WORD_BITS) {}
+
+//! \details Only the first and last words need a partial mask; the words in between are set or cleared whole.
+size_t BitmapRing::mark(const size_t first, const size_t last, const bool occupied) {
+    size_t changed = 0;
+    size_t slot = first;
+    while (slot < last) {
+        const size_t word = slot / WORD_BITS;
+        const size_t offset = slot % WORD_BITS;
+        const size_t bits = min(WORD_BITS - offset, last - slot);
+        const uint64_t mask = (bits == WORD_BITS ? ~uint64_t{0} : ((uint64_t{1} << bits) - 1)) << offset;
+        if (occupied) {
+            changed += __builtin_popcountll(mask & ~_occupied[word]);
+            _occupied[word] |= mask;
+        } else {
+            changed += __builtin_popcountll(mask & _occupied[word]);
+            _occupied[word] &= ~mask;
+        }
+        slot += bits;
+    }
+    return changed;
+}
+
+//! \param[in] index is the absolute index of the first byte of `data`
+//! \param[in] data is the bytes to store (copied in at most two contiguous spans)
+void BitmapRing::insert(const uint64_t index, const string_view data) {
+    if (data.empty()) {
+        return;
+    }
+    const size_t slot = index % capacity();
+    const size_t first_span = min(data.size(), capacity() - slot);
+    memcpy(_bytes.data() + slot, data.data(), first_span);
+    memcpy(_bytes.data(), data.data() + first_span, data.size() - first_span);
+    _count += mark(slot, slot + first_span, true);
+    _count += mark(0, data.size() - first_span, true);
+}
+
+//! \details XORing each word with `flip` makes the slots being counted read as 0, so ctz finds where the
+//! run stops; whole words in the middle are skipped by a tight loop. Bits past the end of the ring are never set,
+//! so each step is clamped to the end of the ring, where the scan wraps to slot 0.
+size_t BitmapRing::scan(const uint64_t index, const size_t limit, const bool occupied) const {
+    const size_t max_length = min(limit, capacity());
+    const uint64_t flip = occupied ? ~uint64_t{0} : 0;
+    size_t length = 0;
+    size_t slot = capacity() ? index % capacity() : 0;
+    while (length < max_length) {
+        size_t word = slot / WORD_BITS;
+        const uint64_t first = (_occupied[word] ^ flip) >> (slot % WORD_BITS);
+        size_t run = 0;
+        if (first) {
+            run = __builtin_ctzll(first);
+        } else {
+            run = WORD_BITS - slot % WORD_BITS;
+            // no word past the one holding the last slot the limit allows needs to be looked at
+            const size_t last_word = min(_occupied.size(), (slot + max_length - length + WORD_BITS - 1) / WORD_BITS);
+            for (++word; word < last_word && (_occupied[word] ^ flip) == 0; ++word) {
+                run += WORD_BITS;
+            }
+            if (word < last_word) {
+                run += __builtin_ctzll(_occupied[word] ^ flip);
+            }
+        }
+        run = min(run, capacity() - slot);
+        length += run;
+        slot += run;
+        if (slot < capacity()) {
+            break;
+        }
+        slot = 0;
+    }
+    return min(length, max_length);
+}
+
+//! \param[in] index is the absolute index to start scanning from
+size_t BitmapRing::run_length(const uint64_t index) const { return scan(index, capacity(), true); }
+
+//! \param[in] index is the absolute index to start scanning from
+//! \param[in] limit is the most slots worth scanning
+size_t BitmapRing::hole_length(const uint64_t index, const size_t limit) const { return scan(index, limit, false); }
+
+//! \param[in] index is the absolute index of the first byte to extract
+//! \param[in] n is the number of bytes to extract
+//! \param[out] out receives the bytes
+void BitmapRing::extract(const uint64_t index, const size_t n, string &out) {
+    if (n == 0) {
+        return;
+    }
+    const size_t slot = index % capacity();
+    const size_t first_span = min(n, capacity() - slot);
+    out.append(_bytes.data() + slot, first_span);
+    out.append(_bytes.data(), n - first_span);
+    _count -= mark(slot, slot + first_span, false);
+    _count -= mark(0, n - first_span, false);
+}
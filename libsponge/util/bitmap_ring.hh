@@ -0,0 +1,50 @@
+#ifndef SPONGE_LIBSPONGE_BITMAP_RING_HH
+#define SPONGE_LIBSPONGE_BITMAP_RING_HH
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//! \brief A fixed-capacity byte ring addressed by absolute index, with an occupancy bitmap
+//!
+//! Byte `index` lives in slot `index % capacity`, so any window of `capacity` consecutive
+//! indices can be held at once. One bit per slot records whether the slot holds data;
+//! the bitmap is scanned a 64-bit word at a time (popcount to count, ctz to find holes).
+//! Memory use is fixed at capacity * 9/8 bytes, however the data arrives.
+class BitmapRing {
+  private:
+    std::vector<char> _bytes;
+    std::vector<uint64_t> _occupied;  //!< bit `slot % 64` of word `slot / 64` is set iff the slot holds data
+    size_t _count{0};                 //!< number of occupied slots
+
+    //! Set (or clear) the bits of slots [first, last), which must not wrap; returns how many bits changed
+    size_t mark(const size_t first, const size_t last, const bool occupied);
+
+    //! Count the consecutive slots from `index` that are occupied (or free), wrapping, up to `limit` of them
+    size_t scan(const uint64_t index, const size_t limit, const bool occupied) const;
+
+  public:
+    //! Construct a ring with room for `capacity` bytes
+    explicit BitmapRing(const size_t capacity);
+
+    //! \returns the number of slots in the ring
+    size_t capacity() const { return _bytes.size(); }
+
+    //! \returns the number of occupied slots
+    size_t count() const { return _count; }
+
+    //! Store `data` at indices [index, index + data.size()); the range must span at most capacity() bytes
+    void insert(const uint64_t index, const std::string_view data);
+
+    //! \returns the number of consecutive occupied slots starting at `index`
+    size_t run_length(const uint64_t index) const;
+
+    //! \returns the number of consecutive free slots starting at `index`, scanning no further than `limit` slots
+    size_t hole_length(const uint64_t index, const size_t limit) const;
+
+    //! Append the `n` bytes starting at `index` to `out` and free their slots
+    void extract(const uint64_t index, const size_t n, std::string &out);
+};
+
+#endif  // SPONGE_LIBSPONGE_BITMAP_RING_HH
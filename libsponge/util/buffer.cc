@@ -7,11 +7,25 @@ void Buffer::remove_prefix(const size_t n) {
         throw out_of_range("Buffer::remove_prefix");
     }
     _starting_offset += n;
-    if (_storage and _starting_offset == _storage->size()) {
+    _length -= n;
+    if (_storage and _length == 0) {
         _storage.reset();
     }
 }
 
+Buffer Buffer::substr(const size_t pos, const size_t n) const {
+    if (pos > size()) {
+        throw out_of_range("Buffer::substr");
+    }
+    Buffer ret;
+    ret._length = min(n, size() - pos);
+    if (ret._length > 0) {
+        ret._storage = _storage;
+        ret._starting_offset = _starting_offset + pos;
+    }
+    return ret;
+}
+
 void BufferList::append(const BufferList &other) {
     for (const auto &buf : other._buffers) {
         _buffers.push_back(buf);
@@ -16,12 +16,14 @@ class Buffer {
   private:
     std::shared_ptr<std::string> _storage{};
     size_t _starting_offset{};
+    size_t _length{};
 
   public:
     Buffer() = default;
 
     //! \brief Construct by taking ownership of a string
-    Buffer(std::string &&str) noexcept : _storage(std::make_shared<std::string>(std::move(str))) {}
+    Buffer(std::string &&str) noexcept
+        : _storage(std::make_shared<std::string>(std::move(str))), _length(_storage->size()) {}
 
     //! \name Expose contents as a std::string_view
     //!@{
@@ -29,7 +31,7 @@ class Buffer {
         if (not _storage) {
             return {};
         }
-        return {_storage->data() + _starting_offset, _storage->size() - _starting_offset};
+        return {_storage->data() + _starting_offset, _length};
     }
 
     operator std::string_view() const { return str(); }
@@ -41,12 +43,18 @@ class Buffer {
     //! \brief Size of the string
     size_t size() const { return str().size(); }
 
+    //! \brief Size of the storage this Buffer keeps alive, shared with the Buffers it was sliced from
+    size_t storage_size() const { return _storage ? _storage->size() : 0; }
+
     //! \brief Make a copy to a new std::string
     std::string copy() const { return std::string(str()); }
 
     //! \brief Discard the first `n` bytes of the string (does not require a copy or move)
     //! \note Doesn't free any memory until the whole string has been discarded in all copies of the Buffer.
     void remove_prefix(const size_t n);
+
+    //! \brief A Buffer viewing `n` bytes starting at `pos`, sharing this Buffer's storage (no copy)
+    Buffer substr(const size_t pos, const size_t n = std::string_view::npos) const;
 };
 
 //! \brief A reference-counted discontiguous string that can discard bytes from the front
@@ -80,6 +88,9 @@ class BufferList {
     //! \brief Append a BufferList
     void append(const BufferList &other);
 
+    //! \brief Append a Buffer (without building a BufferList around it first)
+    void append(Buffer buffer) { _buffers.push_back(std::move(buffer)); }
+
     //! \brief Transform to a Buffer
     //! \note Throws an exception unless BufferList is contiguous
     operator Buffer() const;
@@ -0,0 +1,76 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main() {
+    try {
+        {
+            ByteStreamTestHarness test{"chunked: write-write-pop-across-chunks", 15, ByteStream::Mode::Chunked};
+
+            test.execute(Write{"cat"});
+            test.execute(Write{"tac"});
+
+            test.execute(BytesWritten{6});
+            test.execute(RemainingCapacity{9});
+            test.execute(BufferSize{6});
+            test.execute(Peek{"cattac"});
+
+            test.execute(Pop{4});
+
+            test.execute(BytesRead{4});
+            test.execute(RemainingCapacity{13});
+            test.execute(BufferSize{2});
+            test.execute(Peek{"ac"});
+
+            test.execute(EndInput{});
+            test.execute(Pop{2});
+
+            test.execute(BufferEmpty{true});
+            test.execute(Eof{true});
+        }
+
+        {
+            ByteStreamTestHarness test{"chunked: overwrite-pop-overwrite", 2, ByteStream::Mode::Chunked};
+
+            test.execute(Write{"cat"}.with_bytes_written(2));
+            test.execute(Pop{1});
+            test.execute(Write{"tac"}.with_bytes_written(1));
+
+            test.execute(BytesRead{1});
+            test.execute(BytesWritten{3});
+            test.execute(RemainingCapacity{0});
+            test.execute(BufferSize{2});
+            test.execute(Peek{"at"});
+        }
+
+        {
+            // reads within one written Buffer share its storage instead of copying it
+            ByteStream stream{10, ByteStream::Mode::Chunked};
+            Buffer data{string("abcdefghijkl")};
+            if (stream.write(data) != 10) {
+                throw runtime_error("chunked: write of an oversized Buffer should accept exactly the capacity");
+            }
+            const Buffer first = stream.read_buffer(4);
+            if (first.str() != "abcd" or first.str().data() != data.str().data()) {
+                throw runtime_error("chunked: read_buffer() should return a slice of the written Buffer");
+            }
+            stream.write(Buffer{string("XYZ")});
+            const Buffer rest = stream.read_buffer(9);
+            if (rest.str() != "efghijXYZ") {
+                throw runtime_error("chunked: read_buffer() across chunks returned \"" + rest.copy() + "\"");
+            }
+            if (not stream.buffer_empty() or stream.bytes_read() != 13) {
+                throw runtime_error("chunked: wrong accounting after read_buffer()");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
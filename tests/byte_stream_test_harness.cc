@@ -45,11 +45,13 @@ void ByteStreamAction::execute(ByteStream &) const {}
 
 ByteStreamAction::~ByteStreamAction() {}
 
-ByteStreamTestHarness::ByteStreamTestHarness(const std::string &test_name, const size_t capacity)
-    : _test_name(test_name), _byte_stream(capacity) {
+ByteStreamTestHarness::ByteStreamTestHarness(const std::string &test_name,
+                                             const size_t capacity,
+                                             const ByteStream::Mode mode)
+    : _test_name(test_name), _byte_stream(capacity, mode) {
     std::ostringstream ss;
     ss << "Initialized with ("
-       << "capacity=" << capacity << ")";
+       << "capacity=" << capacity << (mode == ByteStream::Mode::Chunked ? ", mode=chunked" : "") << ")";
     _steps_executed.emplace_back(ss.str());
 }
 
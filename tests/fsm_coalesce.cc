@@ -0,0 +1,111 @@
+#include "tcp_config.hh"
+#include "tcp_connection.hh"
+#include "tcp_segment.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//! Take the segments `from` has queued, without delivering them
+static vector<TCPSegment> collect(TCPConnection &from) {
+    vector<TCPSegment> segments;
+    while (not from.segments_out().empty()) {
+        segments.push_back(move(from.segments_out().front()));
+        from.segments_out().pop();
+    }
+    return segments;
+}
+
+//! Deliver every segment `from` has queued to `to`
+static void exchange(TCPConnection &from, TCPConnection &to) {
+    for (const auto &seg : collect(from)) {
+        to.segment_received(seg);
+    }
+}
+
+//! Connect `a` to `b`, delivering every segment of the handshake
+static void establish(TCPConnection &a, TCPConnection &b) {
+    a.connect();
+    exchange(a, b);
+    exchange(b, a);
+    exchange(a, b);
+    if (not a.active() or not b.active() or a.bytes_in_flight() or b.bytes_in_flight()) {
+        throw runtime_error("the handshake did not complete");
+    }
+}
+
+//! Deliver what `a` has queued to `b`, which must then have all its data acknowledged
+static void expect_acknowledged(TCPConnection &a, TCPConnection &b, const string &name) {
+    exchange(a, b);
+    if (b.bytes_in_flight() != 0) {
+        throw runtime_error(name + ": the peer's data was not acknowledged");
+    }
+}
+
+int main() {
+    try {
+        // test 1: data arriving while the local side is corked is acknowledged anyway
+        {
+            TCPConnection a{TCPConfig{}}, b{TCPConfig{}};
+            establish(a, b);
+            a.set_cork(true);
+            if (a.write(string(10, 'a')) != 10 or not a.segments_out().empty()) {
+                throw runtime_error("test 1 failed: a corked write was sent");
+            }
+            b.write(string(100, 'b'));
+            exchange(b, a);
+            expect_acknowledged(a, b, "test 1 failed");
+            if (a.inbound_stream().read(100) != string(100, 'b')) {
+                throw runtime_error("test 1 failed: the data was not received");
+            }
+        }
+
+        // test 2: so is data arriving while Nagle's algorithm holds a small write back
+        {
+            TCPConfig cfg{};
+            cfg.no_delay = false;
+            TCPConnection a{cfg}, b{TCPConfig{}};
+            establish(a, b);
+            a.write(string(10, 'a'));
+            const vector<TCPSegment> in_flight = collect(a);
+            a.write(string(10, 'c'));
+            if (not a.segments_out().empty()) {
+                throw runtime_error("test 2 failed: Nagle did not hold the second write");
+            }
+            // b's data is sent before the first write reaches it, so it doesn't release the second
+            b.write(string(100, 'b'));
+            exchange(b, a);
+            expect_acknowledged(a, b, "test 2 failed");
+            for (const auto &seg : in_flight) {
+                b.segment_received(seg);
+            }
+        }
+
+        // test 3: with delayed ACKs, the acknowledgment waits for the timer but is not lost
+        {
+            TCPConfig cfg{};
+            cfg.delayed_ack = true;
+            TCPConnection a{cfg}, b{TCPConfig{}};
+            establish(a, b);
+            a.set_cork(true);
+            a.write(string(10, 'a'));
+            b.write(string(100, 'b'));
+            exchange(b, a);
+            if (not a.segments_out().empty()) {
+                throw runtime_error("test 3 failed: a single segment was acknowledged at once");
+            }
+            a.tick(cfg.delayed_ack_timeout);
+            expect_acknowledged(a, b, "test 3 failed");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
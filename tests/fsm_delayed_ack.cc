@@ -0,0 +1,131 @@
+#include "tcp_config.hh"
+#include "tcp_expectation.hh"
+#include "tcp_fsm_test_harness.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using State = TCPTestHarness::State;
+
+static constexpr size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        TCPConfig cfg{};
+        cfg.delayed_ack = true;
+
+        // an established connection whose peer sends data starting at seq_base + 1
+        const auto establish = [&](TCPTestHarness &test, const WrappingInt32 seq_base) {
+            test.execute(Listen{});
+            test.send_syn(seq_base);
+            TCPSegment seg = test.expect_seg(ExpectOneSegment{}.with_syn(true).with_ack(true).with_ackno(seq_base + 1),
+                                             "SYN/ACK was not sent at once");
+            const WrappingInt32 ack_base = seg.header().seqno + 1;
+            test.send_ack(seq_base + 1, ack_base, 60000);
+            test.execute(ExpectState{State::ESTABLISHED});
+            return ack_base;
+        };
+        const auto data = [](const WrappingInt32 seqno, const WrappingInt32 ackno, const size_t size) {
+            return SendSegment{}.with_ack(true).with_ackno(ackno).with_seqno(seqno).with_win(60000).with_data(
+                string(size, 'x'));
+        };
+
+        // test 1: one segment waits for the timer, the second full segment is acknowledged at once
+        {
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_1(cfg);
+            const WrappingInt32 ack_base = establish(test_1, seq_base);
+
+            test_1.execute(data(seq_base + 1, ack_base, MSS));
+            test_1.execute(ExpectNoSegment{}, "test 1 failed: first segment acknowledged at once");
+            test_1.execute(Tick{cfg.delayed_ack_timeout - 1u});
+            test_1.execute(ExpectNoSegment{}, "test 1 failed: ACK sent before the delayed-ACK timeout");
+            test_1.execute(Tick{1});
+            test_1.execute(ExpectOneSegment{}.with_ack(true).with_ackno(seq_base + 1 + MSS).with_payload_size(0),
+                           "test 1 failed: no ACK when the delayed-ACK timer expired");
+
+            test_1.execute(data(seq_base + 1 + MSS, ack_base, MSS));
+            test_1.execute(ExpectNoSegment{});
+            test_1.execute(data(seq_base + 1 + 2 * MSS, ack_base, MSS));
+            test_1.execute(ExpectOneSegment{}.with_ack(true).with_ackno(seq_base + 1 + 3 * MSS),
+                           "test 1 failed: second full segment was not acknowledged at once");
+            test_1.execute(Tick{cfg.delayed_ack_timeout});
+            test_1.execute(ExpectNoSegment{}, "test 1 failed: ACK sent twice");
+        }
+
+        // test 2: outgoing data carries the pending ACK
+        {
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_2(cfg);
+            const WrappingInt32 ack_base = establish(test_2, seq_base);
+
+            test_2.execute(data(seq_base + 1, ack_base, 100));
+            test_2.execute(ExpectNoSegment{});
+            test_2.execute(Write{"reply"}.with_bytes_written(5));
+            test_2.execute(ExpectOneSegment{}.with_ack(true).with_ackno(seq_base + 101).with_data("reply"),
+                           "test 2 failed: reply did not carry the ACK");
+            test_2.execute(Tick{cfg.delayed_ack_timeout});
+            test_2.execute(ExpectNoSegment{}, "test 2 failed: pure ACK sent after a piggybacked one");
+        }
+
+        // test 3: out-of-order data, hole-filling data and FIN are acknowledged at once
+        {
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_3(cfg);
+            const WrappingInt32 ack_base = establish(test_3, seq_base);
+
+            test_3.execute(data(seq_base + 1 + MSS, ack_base, MSS));
+            test_3.execute(ExpectOneSegment{}.with_ack(true).with_ackno(seq_base + 1),
+                           "test 3 failed: out-of-order segment not acknowledged at once");
+            test_3.execute(data(seq_base + 1, ack_base, MSS));
+            test_3.execute(ExpectOneSegment{}.with_ack(true).with_ackno(seq_base + 1 + 2 * MSS),
+                           "test 3 failed: hole-filling segment not acknowledged at once");
+            test_3.execute(SendSegment{}.with_ack(true).with_fin(true).with_ackno(ack_base).with_seqno(seq_base + 1 + 2 * MSS));
+            test_3.execute(ExpectOneSegment{}.with_ack(true).with_ackno(seq_base + 2 + 2 * MSS),
+                           "test 3 failed: FIN not acknowledged at once");
+        }
+
+        // test 4: quick ACK sends the pending ACK and then acknowledges every segment
+        {
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_4(cfg);
+            const WrappingInt32 ack_base = establish(test_4, seq_base);
+
+            test_4.execute(data(seq_base + 1, ack_base, 10));
+            test_4.execute(ExpectNoSegment{});
+            test_4.execute(SetQuickAck{true});
+            test_4.execute(ExpectOneSegment{}.with_ack(true).with_ackno(seq_base + 11),
+                           "test 4 failed: turning on quick ACK did not flush the pending ACK");
+            test_4.execute(data(seq_base + 11, ack_base, 10));
+            test_4.execute(ExpectOneSegment{}.with_ack(true).with_ackno(seq_base + 21),
+                           "test 4 failed: segment not acknowledged at once in quick-ACK mode");
+            test_4.execute(SetQuickAck{false});
+            test_4.execute(data(seq_base + 21, ack_base, 10));
+            test_4.execute(ExpectNoSegment{}, "test 4 failed: ACK not delayed after quick ACK was turned off");
+        }
+
+        // test 5: without delayed ACKs every segment is acknowledged at once
+        {
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_5(TCPConfig{});
+            const WrappingInt32 ack_base = establish(test_5, seq_base);
+
+            test_5.execute(data(seq_base + 1, ack_base, 10));
+            test_5.execute(ExpectOneSegment{}.with_ack(true).with_ackno(seq_base + 11),
+                           "test 5 failed: ACK delayed although delayed ACKs are off");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
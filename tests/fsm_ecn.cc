@@ -0,0 +1,213 @@
+#include "congestion_control.hh"
+#include "ipv4_header.hh"
+#include "tcp_config.hh"
+#include "tcp_expectation.hh"
+#include "tcp_fsm_test_harness.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+using State = TCPTestHarness::State;
+using ECN = IPv4Header::ECN;
+
+static constexpr size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        TCPConfig cfg{};
+        cfg.ecn = true;
+
+        // test 1: listen -> ECN-setup SYN -> ECN-setup SYN/ACK; data is ECN-capable and CE marks are echoed
+        {
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_1(cfg);
+
+            test_1.execute(Listen{});
+            test_1.execute(
+                SendSegment{}.with_syn(true).with_ece(true).with_cwr(true).with_seqno(seq_base).with_win(4096));
+            TCPSegment seg = test_1.expect_seg(
+                ExpectOneSegment{}.with_syn(true).with_ack(true).with_ece(true).with_cwr(false).with_ecn(ECN::NotECT),
+                "test 1 failed: no ECN-setup SYN/ACK");
+            const WrappingInt32 ack_base = seg.header().seqno + 1;
+
+            test_1.execute(SendSegment{}.with_ack(true).with_seqno(seq_base + 1).with_ackno(ack_base).with_win(4096));
+            test_1.execute(ExpectState{State::ESTABLISHED});
+
+            test_1.execute(Write{"abc"});
+            test_1.execute(ExpectOneSegment{}.with_data("abc").with_ecn(ECN::ECT0).with_ece(false),
+                           "test 1 failed: data not sent ECN-capable");
+
+            // a CE mark is echoed on the ACK for it, which is not itself ECN-capable
+            test_1.execute(SendSegment{}
+                               .with_ack(true)
+                               .with_seqno(seq_base + 1)
+                               .with_ackno(ack_base + 3)
+                               .with_win(4096)
+                               .with_ecn(ECN::CE)
+                               .with_data("hello"));
+            test_1.execute(ExpectOneSegment{}.with_ackno(seq_base + 6).with_ece(true).with_ecn(ECN::NotECT),
+                           "test 1 failed: CE mark not echoed");
+
+            // an unmarked segment ends the echo
+            test_1.execute(SendSegment{}
+                               .with_ack(true)
+                               .with_seqno(seq_base + 6)
+                               .with_ackno(ack_base + 3)
+                               .with_win(4096)
+                               .with_ecn(ECN::ECT0)
+                               .with_data("world"));
+            test_1.execute(ExpectOneSegment{}.with_ackno(seq_base + 11).with_ece(false),
+                           "test 1 failed: ECE kept after an unmarked segment");
+            test_1.execute(ExpectData{}.with_data("helloworld"));
+        }
+
+        // test 2: active open with DCTCP -> an ECN-Echo makes the next data segment carry CWR, once
+        {
+            const WrappingInt32 seq_base(rd());
+            TCPConfig dctcp_cfg = cfg;
+            dctcp_cfg.congestion_control = CongestionControl::Algorithm::DCTCP;
+            TCPTestHarness test_2(dctcp_cfg);
+
+            test_2.execute(Connect{});
+            TCPSegment seg = test_2.expect_seg(
+                ExpectOneSegment{}.with_syn(true).with_ece(true).with_cwr(true).with_ecn(ECN::NotECT),
+                "test 2 failed: SYN did not offer ECN");
+            const WrappingInt32 isn = seg.header().seqno;
+
+            test_2.execute(SendSegment{}
+                               .with_syn(true)
+                               .with_ack(true)
+                               .with_ece(true)
+                               .with_seqno(seq_base)
+                               .with_ackno(isn + 1)
+                               .with_win(4096));
+            test_2.execute(ExpectOneSegment{}.with_ack(true).with_ece(false).with_cwr(false).with_ecn(ECN::NotECT));
+            test_2.execute(ExpectState{State::ESTABLISHED});
+
+            const auto ece_ack = [&](const uint32_t acked) {
+                return SendSegment{}
+                    .with_ack(true)
+                    .with_ece(true)
+                    .with_seqno(seq_base + 1)
+                    .with_ackno(isn + 1 + acked)
+                    .with_win(4096);
+            };
+            test_2.execute(Write{"abc"});
+            test_2.execute(ExpectOneSegment{}.with_data("abc").with_ecn(ECN::ECT0).with_cwr(false));
+            test_2.execute(Write{"def"});
+            test_2.execute(ExpectOneSegment{}.with_data("def").with_ecn(ECN::ECT0).with_cwr(false));
+            test_2.execute(ece_ack(3));
+            test_2.execute(Write{"ghi"});
+            test_2.execute(ExpectOneSegment{}.with_data("ghi").with_ecn(ECN::ECT0).with_cwr(true),
+                           "test 2 failed: window reduction not signalled with CWR");
+
+            // ECN-Echo for data sent before the reduction doesn't reduce the window again
+            test_2.execute(ece_ack(6));
+            test_2.execute(Write{"jkl"});
+            test_2.execute(ExpectOneSegment{}.with_data("jkl").with_cwr(false),
+                           "test 2 failed: reduced the window twice in one window of data");
+
+            // but ECN-Echo for data sent after it does
+            test_2.execute(ece_ack(9));
+            test_2.execute(Write{"mno"});
+            test_2.execute(ExpectOneSegment{}.with_data("mno").with_cwr(true),
+                           "test 2 failed: no reduction for marks on data sent after the last one");
+        }
+
+        // test 3: active open, the peer doesn't agree to ECN -> data is not ECN-capable
+        {
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_3(cfg);
+
+            test_3.execute(Connect{});
+            TCPSegment seg = test_3.expect_seg(ExpectOneSegment{}.with_syn(true).with_ece(true).with_cwr(true),
+                                               "test 3 failed: SYN did not offer ECN");
+            const WrappingInt32 isn = seg.header().seqno;
+
+            test_3.execute(
+                SendSegment{}.with_syn(true).with_ack(true).with_seqno(seq_base).with_ackno(isn + 1).with_win(4096));
+            test_3.execute(ExpectOneSegment{}.with_ack(true).with_ece(false));
+            test_3.execute(Write{"abc"});
+            test_3.execute(ExpectOneSegment{}.with_data("abc").with_ecn(ECN::NotECT),
+                           "test 3 failed: ECN-capable data sent without the peer's agreement");
+            test_3.execute(SendSegment{}
+                               .with_ack(true)
+                               .with_seqno(seq_base + 1)
+                               .with_ackno(isn + 4)
+                               .with_win(4096)
+                               .with_ecn(ECN::CE)
+                               .with_data("hello"));
+            test_3.execute(ExpectOneSegment{}.with_ackno(seq_base + 6).with_ece(false),
+                           "test 3 failed: CE mark echoed without ECN");
+        }
+
+        // test 4: ECN is off by default, and a peer's offer goes unanswered
+        {
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_4(TCPConfig{});
+
+            test_4.execute(Listen{});
+            test_4.execute(
+                SendSegment{}.with_syn(true).with_ece(true).with_cwr(true).with_seqno(seq_base).with_win(4096));
+            test_4.execute(ExpectOneSegment{}.with_syn(true).with_ack(true).with_ece(false).with_cwr(false),
+                           "test 4 failed: answered an ECN offer without being configured to");
+        }
+
+        // test 5: DCTCP cuts cwnd in proportion to the fraction of bytes marked
+        {
+            DCTCP dctcp{MSS};
+            const uint64_t initial = dctcp.cwnd();
+
+            // alpha starts at 1: the first echo halves the window, like a loss would
+            dctcp.on_ecn_echo(initial, 0);
+            if (dctcp.cwnd() != initial / 2 or dctcp.ssthresh() != initial / 2) {
+                throw runtime_error("test 5 failed: the first ECN-Echo didn't halve cwnd");
+            }
+
+            // a window without marks: alpha decays by G
+            const uint64_t window = dctcp.cwnd();
+            for (uint64_t acked = 0; acked < initial; acked += MSS) {
+                dctcp.on_ack({MSS, window, 0, false});
+            }
+            if (dctcp.alpha() != 1 - DCTCP::G) {
+                throw runtime_error("test 5 failed: alpha is " + to_string(dctcp.alpha()));
+            }
+
+            // a window with every byte marked: alpha moves towards 1 by G
+            while (dctcp.alpha() == 1 - DCTCP::G) {
+                dctcp.on_ack({MSS, dctcp.cwnd(), 0, true});
+            }
+            const double alpha = (1 - DCTCP::G) * (1 - DCTCP::G) + DCTCP::G;
+            if (dctcp.alpha() != alpha) {
+                throw runtime_error("test 5 failed: alpha is " + to_string(dctcp.alpha()));
+            }
+            const uint64_t cwnd = dctcp.cwnd();
+            dctcp.on_ecn_echo(cwnd, 0);
+            if (dctcp.cwnd() != static_cast<uint64_t>(double(cwnd) * (1 - alpha / 2))) {
+                throw runtime_error("test 5 failed: cwnd not cut by alpha / 2");
+            }
+
+            // never below two segments
+            for (unsigned i = 0; i < 10; ++i) {
+                dctcp.on_ecn_echo(dctcp.cwnd(), 0);
+            }
+            if (dctcp.cwnd() != 2 * MSS) {
+                throw runtime_error("test 5 failed: cwnd fell below two segments");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
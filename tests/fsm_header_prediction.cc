@@ -0,0 +1,116 @@
+#include "tcp_config.hh"
+#include "tcp_connection.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//! What crossed the wire in a transfer, and how much of it header prediction handled
+struct Transfer {
+    vector<string> segments{};  //!< every segment sent, serialized, with its ECN codepoint appended
+    size_t predicted{0};        //!< segments the two ends handled by header prediction
+    size_t data_segments{0};    //!< segments carrying data, counted to pick the ones lost
+};
+
+//! Carry segments from `from` to `to`, dropping every `drop_every`th data segment if it is nonzero
+static void exchange(TCPConnection &from, TCPConnection &to, Transfer &transfer, const size_t drop_every = 0) {
+    while (not from.segments_out().empty()) {
+        TCPSegment seg = move(from.segments_out().front());
+        from.segments_out().pop();
+        transfer.segments.push_back(seg.serialize().concatenate() + char(seg.ecn()));
+        if (drop_every and seg.payload().size() and ++transfer.data_segments % drop_every == 0) {
+            continue;
+        }
+        to.segment_received(seg);
+    }
+}
+
+//! Send `data` from x to y and some back in the middle, with `cfg` on both ends
+static Transfer transfer(const TCPConfig &cfg, const string &data, const size_t drop_every) {
+    TCPConfig x_cfg = cfg, y_cfg = cfg;
+    x_cfg.fixed_isn = WrappingInt32{1000};
+    y_cfg.fixed_isn = WrappingInt32{2000000000};
+    TCPConnection x{x_cfg}, y{y_cfg};
+    Transfer result;
+
+    x.connect();
+    size_t written = 0;
+    bool x_closed = false;
+    string received;
+    for (unsigned round = 0; not y.inbound_stream().eof(); ++round) {
+        if (round > 100000) {
+            throw runtime_error("the transfer did not finish");
+        }
+        written += x.write(data.substr(written, 5000));
+        if (written == data.size() and not x_closed) {
+            x.end_input_stream();
+            x_closed = true;
+        }
+        if (round % 7 == 3) {
+            y.write(string(100, 'r'));
+        }
+        exchange(x, y, result, drop_every);
+        exchange(y, x, result);
+        received += y.inbound_stream().read(y.inbound_stream().buffer_size());
+        x.inbound_stream().pop_output(x.inbound_stream().buffer_size());
+        x.tick(5);
+        y.tick(5);
+    }
+    if (received != data) {
+        throw runtime_error("the data arrived corrupted");
+    }
+    result.predicted = x.predicted_segments() + y.predicted_segments();
+    return result;
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        string data(200000, 0);
+        for (auto &ch : data) {
+            ch = rd();
+        }
+
+        vector<TCPConfig> cfgs(5);
+        cfgs[1].delayed_ack = true;
+        cfgs[2].timestamps = true;
+        cfgs[2].recv_capacity = 200000;
+        cfgs[3].ecn = true;
+        cfgs[3].congestion_control = CongestionControl::Algorithm::DCTCP;
+        cfgs[4].fast_retransmit = true;
+        cfgs[4].congestion_control = CongestionControl::Algorithm::NewReno;
+
+        for (size_t i = 0; i < cfgs.size(); ++i) {
+            for (const size_t drop_every : {0, 13}) {
+                const string name = "configuration " + to_string(i) + (drop_every ? " with loss" : "");
+                TCPConfig cfg = cfgs[i];
+                const Transfer predicted = transfer(cfg, data, drop_every);
+                cfg.header_prediction = false;
+                const Transfer general = transfer(cfg, data, drop_every);
+
+                if (predicted.predicted == 0) {
+                    throw runtime_error(name + ": no segment was predicted");
+                }
+                if (general.predicted != 0) {
+                    throw runtime_error(name + ": segments predicted with header prediction off");
+                }
+                if (predicted.segments != general.segments) {
+                    throw runtime_error(name + ": header prediction changed what was sent");
+                }
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
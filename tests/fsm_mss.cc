@@ -0,0 +1,93 @@
+#include "tcp_config.hh"
+#include "tcp_expectation.hh"
+#include "tcp_fsm_test_harness.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using State = TCPTestHarness::State;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // test 1: listen -> peer advertises a smaller MSS -> segments are sized to it
+        {
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_1(TCPConfig{});
+
+            test_1.execute(Listen{});
+            test_1.execute(SendSegment{}.with_syn(true).with_seqno(seq_base).with_win(4096).with_mss(400));
+            TCPSegment seg = test_1.expect_seg(
+                ExpectOneSegment{}.with_syn(true).with_ack(true).with_mss(TCPConfig::MAX_PAYLOAD_SIZE),
+                "test 1 failed: SYN/ACK did not advertise the configured MSS");
+            const WrappingInt32 ack_base = seg.header().seqno + 1;
+
+            test_1.send_ack(seq_base + 1, ack_base, 4096);
+            test_1.execute(ExpectState{State::ESTABLISHED});
+            test_1.execute(Write{string(1000, 'x')}.with_bytes_written(1000));
+            test_1.execute(ExpectSegment{}.with_payload_size(400).with_seqno(ack_base).with_mss(nullopt),
+                           "test 1 failed: segment not sized to the peer's MSS");
+            test_1.execute(ExpectSegment{}.with_payload_size(400).with_seqno(ack_base + 400));
+            test_1.execute(ExpectOneSegment{}.with_payload_size(200).with_seqno(ack_base + 800));
+        }
+
+        // test 2: active open -> SYN advertises our MSS, the peer's larger one leaves ours in effect
+        {
+            TCPConfig cfg{};
+            cfg.mss = 600;
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_2(cfg);
+
+            test_2.execute(Connect{});
+            TCPSegment seg = test_2.expect_seg(ExpectOneSegment{}.with_syn(true).with_ack(false).with_mss(600),
+                                               "test 2 failed: SYN did not advertise the configured MSS");
+            const WrappingInt32 isn = seg.header().seqno;
+
+            test_2.execute(SendSegment{}
+                               .with_syn(true)
+                               .with_ack(true)
+                               .with_seqno(seq_base)
+                               .with_ackno(isn + 1)
+                               .with_win(4096)
+                               .with_mss(1460));
+            test_2.execute(ExpectOneSegment{}.with_ack(true).with_ackno(seq_base + 1).with_payload_size(0));
+            test_2.execute(ExpectState{State::ESTABLISHED});
+            test_2.execute(Write{string(1000, 'x')}.with_bytes_written(1000));
+            test_2.execute(ExpectSegment{}.with_payload_size(600).with_seqno(isn + 1),
+                           "test 2 failed: segment larger than our MSS");
+            test_2.execute(ExpectOneSegment{}.with_payload_size(400).with_seqno(isn + 601));
+        }
+
+        // test 3: a peer sending no MSS option is assumed to take ours
+        {
+            TCPConfig cfg{};
+            cfg.mss = 700;
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_3(cfg);
+
+            test_3.execute(Listen{});
+            test_3.send_syn(seq_base);
+            TCPSegment seg = test_3.expect_seg(ExpectOneSegment{}.with_syn(true).with_ack(true).with_mss(700));
+            const WrappingInt32 ack_base = seg.header().seqno + 1;
+
+            test_3.send_ack(seq_base + 1, ack_base, 4096);
+            test_3.execute(Write{string(1000, 'x')}.with_bytes_written(1000));
+            test_3.execute(ExpectSegment{}.with_payload_size(700).with_seqno(ack_base),
+                           "test 3 failed: segment not sized to our MSS");
+            test_3.execute(ExpectOneSegment{}.with_payload_size(300).with_seqno(ack_base + 700));
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,99 @@
+#include "tcp_config.hh"
+#include "tcp_expectation.hh"
+#include "tcp_fsm_test_harness.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using State = TCPTestHarness::State;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // test 1: listen -> peer permits SACK -> out-of-order data is reported, most recent block first
+        for (const auto backend : {StreamReassembler::Backend::Map, StreamReassembler::Backend::Bitmap}) {
+            TCPConfig cfg{};
+            cfg.reassembler_backend = backend;
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_1(cfg);
+
+            test_1.execute(Listen{});
+            test_1.execute(SendSegment{}.with_syn(true).with_seqno(seq_base).with_win(4096).with_sack_permitted(true));
+            TCPSegment seg = test_1.expect_seg(ExpectOneSegment{}.with_syn(true).with_ack(true).with_sack_permitted(true),
+                                               "test 1 failed: SYN/ACK did not permit SACK");
+            const WrappingInt32 ack_base = seg.header().seqno + 1;
+            test_1.send_ack(seq_base + 1, ack_base, 4096);
+            test_1.execute(ExpectState{State::ESTABLISHED});
+
+            const auto send = [&](const uint32_t offset, const size_t size) {
+                test_1.execute(SendSegment{}
+                                   .with_ack(true)
+                                   .with_ackno(ack_base)
+                                   .with_seqno(seq_base + 1 + offset)
+                                   .with_data(string(size, 'x')));
+            };
+            const auto block = [&](const uint32_t begin, const uint32_t end) {
+                return TCPHeader::SackBlock{seq_base + 1 + begin, seq_base + 1 + end};
+            };
+
+            send(1000, 500);
+            test_1.execute(ExpectOneSegment{}.with_ackno(seq_base + 1).with_sack({block(1000, 1500)}),
+                           "test 1 failed: ACK of out-of-order data carried no SACK block");
+            send(3000, 500);
+            test_1.execute(ExpectOneSegment{}.with_ackno(seq_base + 1).with_sack({block(3000, 3500), block(1000, 1500)}),
+                           "test 1 failed: the most recent block did not come first");
+            send(1500, 500);
+            test_1.execute(ExpectOneSegment{}.with_ackno(seq_base + 1).with_sack({block(1000, 2000), block(3000, 3500)}),
+                           "test 1 failed: adjacent runs were not merged into one block");
+            send(0, 1000);
+            test_1.execute(ExpectOneSegment{}.with_ackno(seq_base + 1 + 2000).with_sack({block(3000, 3500)}),
+                           "test 1 failed: filled holes were still reported");
+            send(2000, 1000);
+            test_1.execute(ExpectOneSegment{}.with_ackno(seq_base + 1 + 3500).with_sack({}),
+                           "test 1 failed: SACK block sent with nothing held out of order");
+        }
+
+        // test 2: listen -> peer does not permit SACK -> neither SACK-Permitted nor SACK blocks
+        {
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_2(TCPConfig{});
+
+            test_2.execute(Listen{});
+            test_2.send_syn(seq_base);
+            TCPSegment seg =
+                test_2.expect_seg(ExpectOneSegment{}.with_syn(true).with_ack(true).with_sack_permitted(false),
+                                  "test 2 failed: SYN/ACK permitted SACK to a peer that did not");
+            const WrappingInt32 ack_base = seg.header().seqno + 1;
+            test_2.send_ack(seq_base + 1, ack_base, 4096);
+
+            test_2.execute(
+                SendSegment{}.with_ack(true).with_ackno(ack_base).with_seqno(seq_base + 1001).with_data(string(500, 'x')));
+            test_2.execute(ExpectOneSegment{}.with_ackno(seq_base + 1).with_sack({}),
+                           "test 2 failed: SACK block sent without SACK being permitted");
+        }
+
+        // test 3: active open -> SYN permits SACK, unless disabled
+        for (const bool sack : {true, false}) {
+            TCPConfig cfg{};
+            cfg.sack = sack;
+            TCPTestHarness test_3(cfg);
+
+            test_3.execute(Connect{});
+            test_3.execute(ExpectOneSegment{}.with_syn(true).with_ack(false).with_sack_permitted(sack),
+                           "test 3 failed: SYN's SACK-Permitted does not follow the configuration");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
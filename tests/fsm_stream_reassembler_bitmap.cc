@@ -0,0 +1,103 @@
+#include "byte_stream.hh"
+#include "fsm_stream_reassembler_harness.hh"
+#include "stream_reassembler.hh"
+#include "util.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+
+static constexpr unsigned NREPS = 32;
+static constexpr unsigned NSEGS = 256;
+static constexpr unsigned MAX_SEG_LEN = 300;
+
+int main() {
+    try {
+        const auto bitmap = StreamReassembler::Backend::Bitmap;
+
+        {
+            // holes, overlaps and a wrap around the end of the ring
+            ReassemblerTestHarness test{8, bitmap};
+
+            test.execute(SubmitSegment{"cd", 2});
+            test.execute(SubmitSegment{"fg", 5});
+            test.execute(UnassembledBytes(4));
+            test.execute(SubmitSegment{"bcde", 1});
+            test.execute(UnassembledBytes(6));
+            test.execute(BytesAssembled(0));
+
+            test.execute(SubmitSegment{"a", 0});
+            test.execute(BytesAssembled(7));
+            test.execute(UnassembledBytes(0));
+            test.execute(BytesAvailable("abcdefg"));
+
+            test.execute(SubmitSegment{"jklmnop", 9});
+            test.execute(UnassembledBytes(6));
+            test.execute(SubmitSegment{"hi", 7});
+            test.execute(BytesAssembled(15));
+            test.execute(UnassembledBytes(0));
+            test.execute(BytesAvailable("hijklmno"));
+
+            test.execute(SubmitSegment{"p", 15}.with_eof(true));
+            test.execute(BytesAssembled(16));
+            test.execute(BytesAvailable("p"));
+            test.execute(AtEof{});
+        }
+
+        // both backends must assemble the same bytes from the same shuffled, overlapping segments
+        auto rd = get_random_generator();
+        for (unsigned rep_no = 0; rep_no < NREPS; ++rep_no) {
+            const size_t capacity = 1 + rd() % (MAX_SEG_LEN * 8);
+            StreamReassembler map_buf{capacity};
+            StreamReassembler bitmap_buf{capacity, bitmap};
+
+            vector<tuple<size_t, size_t>> seq_size;
+            size_t offset = 0;
+            for (unsigned i = 0; i < NSEGS; ++i) {
+                const size_t size = 1 + (rd() % (MAX_SEG_LEN - 1));
+                const size_t overlap = min(offset, size_t(rd() % 32));
+                seq_size.emplace_back(offset - overlap, size + overlap);
+                offset += size;
+            }
+
+            string d(offset, 0);
+            generate(d.begin(), d.end(), [&] { return rd(); });
+
+            string map_out, bitmap_out;
+            for (size_t first = 0; first < seq_size.size(); first += 8) {
+                const auto last = seq_size.begin() + min(seq_size.size(), first + 8);
+                shuffle(seq_size.begin() + first, last, rd);
+                for (auto it = seq_size.begin() + first; it != last; ++it) {
+                    const auto [off, sz] = *it;
+                    const string dd = d.substr(off, sz);
+                    map_buf.push_substring(dd, off, off + sz == offset);
+                    bitmap_buf.push_substring(dd, off, off + sz == offset);
+                    if (map_buf.unassembled_bytes() != bitmap_buf.unassembled_bytes()) {
+                        throw runtime_error("backends disagree on unassembled_bytes()");
+                    }
+                    map_out += map_buf.stream_out().read(rd() % (capacity + 1));
+                    bitmap_out += bitmap_buf.stream_out().read(map_out.size() - bitmap_out.size());
+                }
+            }
+            map_out += map_buf.stream_out().read(capacity);
+            bitmap_out += bitmap_buf.stream_out().read(capacity);
+
+            if (map_out != bitmap_out or map_buf.stream_out().eof() != bitmap_buf.stream_out().eof()) {
+                throw runtime_error("backends assembled different streams");
+            }
+            if (map_out != d.substr(0, map_out.size())) {
+                throw runtime_error("content of assembled bytes is incorrect");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
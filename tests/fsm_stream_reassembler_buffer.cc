@@ -0,0 +1,120 @@
+#include "buffer.hh"
+#include "byte_stream.hh"
+#include "stream_reassembler.hh"
+#include "util.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+
+static constexpr unsigned NREPS = 32;
+static constexpr unsigned NSEGS = 256;
+static constexpr unsigned MAX_SEG_LEN = 300;
+
+int main() {
+    try {
+        {
+            // overlapping Buffers only fill the gaps between what is already stored
+            StreamReassembler buf{16};
+            buf.push_substring(Buffer{"cd"}, 2, false);
+            buf.push_substring(Buffer{"gh"}, 6, false);
+            buf.push_substring(Buffer{"bcdefgh"}, 1, false);
+            if (buf.unassembled_bytes() != 7 or buf.stream_out().buffer_size() != 0) {
+                throw runtime_error("overlapping Buffers were not stored once each");
+            }
+            buf.push_substring(Buffer{"a"}, 0, false);
+            buf.push_substring(Buffer{"ijklmnopqrst"}, 8, true);
+            if (buf.unassembled_bytes() != 0 or buf.stream_out().read(16) != "abcdefghijklmnop") {
+                throw runtime_error("Buffers assembled incorrectly");
+            }
+            if (buf.stream_out().eof() or buf.stream_out().input_ended()) {
+                throw runtime_error("stream ended although bytes beyond the window were dropped");
+            }
+        }
+
+        {
+            // 1-byte segments are merged into the runs they touch, whatever order the gaps are filled in
+            constexpr size_t NBYTES = 2 * NSEGS;
+            string d(NBYTES, 0);
+            for (size_t i = 0; i < NBYTES; ++i) {
+                d[i] = 'a' + i % 26;
+            }
+            StreamReassembler buf{NBYTES};
+            for (size_t i = 1; i < NBYTES; i += 2) {
+                buf.push_substring(Buffer{d.substr(i, 1)}, i, false);
+            }
+            if (buf.stored_runs() != NSEGS or buf.unassembled_bytes() != NSEGS) {
+                throw runtime_error("separate 1-byte segments were not held as separate runs");
+            }
+            for (size_t i = NBYTES - 2; i > 0; i -= 2) {
+                buf.push_substring(Buffer{d.substr(i, 1)}, i, false);
+                if (buf.stored_runs() != i / 2) {
+                    throw runtime_error("a 1-byte segment was not merged with the runs it touches");
+                }
+            }
+            if (buf.unassembled_bytes() != NBYTES - 1) {
+                throw runtime_error("merged runs lost bytes");
+            }
+            buf.push_substring(Buffer{d.substr(0, 1)}, 0, true);
+            if (buf.stored_runs() != 0 or buf.unassembled_bytes() != 0 or buf.stream_out().read(NBYTES) != d) {
+                throw runtime_error("merged runs assembled incorrectly");
+            }
+        }
+
+        // a Buffer and a std::string carrying the same bytes must assemble identically
+        auto rd = get_random_generator();
+        for (unsigned rep_no = 0; rep_no < NREPS; ++rep_no) {
+            const size_t capacity = 1 + rd() % (MAX_SEG_LEN * 8);
+            StreamReassembler string_buf{capacity};
+            StreamReassembler buffer_buf{capacity};
+
+            vector<tuple<size_t, size_t>> seq_size;
+            size_t offset = 0;
+            for (unsigned i = 0; i < NSEGS; ++i) {
+                const size_t size = 1 + (rd() % (MAX_SEG_LEN - 1));
+                const size_t overlap = min(offset, size_t(rd() % 32));
+                seq_size.emplace_back(offset - overlap, size + overlap);
+                offset += size;
+            }
+
+            string d(offset, 0);
+            generate(d.begin(), d.end(), [&] { return rd(); });
+
+            string string_out, buffer_out;
+            for (size_t first = 0; first < seq_size.size(); first += 8) {
+                const auto last = seq_size.begin() + min(seq_size.size(), first + 8);
+                shuffle(seq_size.begin() + first, last, rd);
+                for (auto it = seq_size.begin() + first; it != last; ++it) {
+                    const auto [off, sz] = *it;
+                    string_buf.push_substring(d.substr(off, sz), off, off + sz == offset);
+                    buffer_buf.push_substring(Buffer{d.substr(off, sz)}, off, off + sz == offset);
+                    if (string_buf.unassembled_bytes() != buffer_buf.unassembled_bytes()) {
+                        throw runtime_error("overloads disagree on unassembled_bytes()");
+                    }
+                    string_out += string_buf.stream_out().read(rd() % (capacity + 1));
+                    buffer_out += buffer_buf.stream_out().read(string_out.size() - buffer_out.size());
+                }
+            }
+            string_out += string_buf.stream_out().read(capacity);
+            buffer_out += buffer_buf.stream_out().read(capacity);
+
+            if (string_out != buffer_out or string_buf.stream_out().eof() != buffer_buf.stream_out().eof()) {
+                throw runtime_error("overloads assembled different streams");
+            }
+            if (string_out != d.substr(0, string_out.size())) {
+                throw runtime_error("content of assembled bytes is incorrect");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
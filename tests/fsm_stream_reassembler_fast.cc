@@ -0,0 +1,70 @@
+#include "byte_stream.hh"
+#include "fsm_stream_reassembler_harness.hh"
+#include "stream_reassembler.hh"
+#include "util.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main() {
+    try {
+        for (const auto backend : {StreamReassembler::Backend::Map, StreamReassembler::Backend::Bitmap}) {
+            // in-order substrings with nothing held go straight into the stream
+            {
+                ReassemblerTestHarness test{65000, backend};
+
+                test.execute(SubmitSegment{"abcd", 0});
+                test.execute(SubmitSegment{"efgh", 4});
+                test.execute(BytesAssembled(8));
+                test.execute(FastPathPushes(2, 2));
+
+                // so do those overlapping what was assembled, or running past the window
+                test.execute(SubmitSegment{"ghij", 6});
+                test.execute(BytesAssembled(10));
+                test.execute(FastPathPushes(3, 3));
+                test.execute(BytesAvailable("abcdefghij"));
+            }
+
+            // an out-of-order substring is held, and the one filling the gap before it is not on the fast path
+            {
+                ReassemblerTestHarness test{65000, backend};
+
+                test.execute(SubmitSegment{"abcd", 0});
+                test.execute(SubmitSegment{"ijkl", 8});
+                test.execute(UnassembledBytes(4));
+                test.execute(FastPathPushes(2, 1));
+
+                test.execute(SubmitSegment{"efgh", 4});
+                test.execute(BytesAssembled(12));
+                test.execute(UnassembledBytes(0));
+                test.execute(FastPathPushes(3, 1));
+
+                // with nothing held any more, the fast path is taken again
+                test.execute(SubmitSegment{"mnop", 12}.with_eof(true));
+                test.execute(FastPathPushes(4, 2));
+                test.execute(BytesAvailable("abcdefghijklmnop"));
+                test.execute(AtEof{});
+            }
+
+            // substrings entirely before the next byte, or beyond the window, are not on it either
+            {
+                ReassemblerTestHarness test{4, backend};
+
+                test.execute(SubmitSegment{"abcd", 0});
+                test.execute(SubmitSegment{"ab", 0});
+                test.execute(SubmitSegment{"efgh", 4});
+                test.execute(FastPathPushes(3, 1));
+                test.execute(BytesAvailable("abcd"));
+                test.execute(SubmitSegment{"efgh", 4});
+                test.execute(FastPathPushes(4, 2));
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
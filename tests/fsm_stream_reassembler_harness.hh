@@ -103,6 +103,28 @@ struct UnassembledBytes : public ReassemblerExpectation {
     }
 };
 
+struct FastPathPushes : public ReassemblerExpectation {
+    size_t _pushes;
+    size_t _fast;
+
+    FastPathPushes(size_t pushes, size_t fast) : _pushes(pushes), _fast(fast) {}
+    std::string description() const {
+        std::ostringstream ss;
+        ss << "pushes = " << _pushes << ", on the fast path = " << _fast;
+        return ss.str();
+    }
+
+    void execute(StreamReassembler &reassembler) const {
+        if (reassembler.pushes() != _pushes or reassembler.fast_path_pushes() != _fast) {
+            std::ostringstream ss;
+            ss << "The reassembler was expected to have taken `" << _fast << "` of `" << _pushes
+               << "` pushes on the fast path, but it took `" << reassembler.fast_path_pushes() << "` of `"
+               << reassembler.pushes() << "`";
+            throw ReassemblerExpectationViolation(ss.str());
+        }
+    }
+};
+
 struct AtEof : public ReassemblerExpectation {
     AtEof() {}
     std::string description() const {
@@ -166,8 +188,11 @@ class ReassemblerTestHarness {
     std::vector<std::string> steps_executed;
 
   public:
-    ReassemblerTestHarness(const size_t capacity) : reassembler(capacity), steps_executed() {
-        steps_executed.emplace_back("Initialized (capacity = " + std::to_string(capacity) + ")");
+    ReassemblerTestHarness(const size_t capacity,
+                           const StreamReassembler::Backend backend = StreamReassembler::Backend::Map)
+        : reassembler(capacity, backend), steps_executed() {
+        steps_executed.emplace_back("Initialized (capacity = " + std::to_string(capacity) +
+                                    (backend == StreamReassembler::Backend::Bitmap ? ", bitmap backend" : "") + ")");
     }
 
     void execute(const ReassemblerTestStep &step) {
@@ -0,0 +1,116 @@
+#include "tcp_config.hh"
+#include "tcp_expectation.hh"
+#include "tcp_fsm_test_harness.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace std;
+using State = TCPTestHarness::State;
+using Timestamps = TCPHeader::Timestamps;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        TCPConfig cfg{};
+        cfg.timestamps = true;
+
+        // test 1: listen -> peer offers timestamps -> every segment is timestamped and echoes TS.Recent
+        {
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_1(cfg);
+
+            test_1.execute(Listen{});
+            test_1.execute(Tick{5});
+            test_1.execute(SendSegment{}.with_syn(true).with_seqno(seq_base).with_win(4096).with_timestamps(1000, 0));
+            TCPSegment seg = test_1.expect_seg(
+                ExpectOneSegment{}.with_syn(true).with_ack(true).with_timestamps(Timestamps{5, 1000}),
+                "test 1 failed: SYN/ACK did not echo the peer's timestamp");
+            const WrappingInt32 ack_base = seg.header().seqno + 1;
+
+            test_1.execute(SendSegment{}
+                               .with_ack(true)
+                               .with_seqno(seq_base + 1)
+                               .with_ackno(ack_base)
+                               .with_win(4096)
+                               .with_timestamps(1010, 5));
+            test_1.execute(ExpectState{State::ESTABLISHED});
+
+            test_1.execute(Tick{20});
+            test_1.execute(SendSegment{}
+                               .with_ack(true)
+                               .with_seqno(seq_base + 1)
+                               .with_ackno(ack_base)
+                               .with_win(4096)
+                               .with_timestamps(1030, 5)
+                               .with_data("hello"));
+            test_1.execute(ExpectOneSegment{}.with_ackno(seq_base + 6).with_timestamps(Timestamps{25, 1030}),
+                           "test 1 failed: ACK did not echo the latest in-order timestamp");
+
+            // an out-of-order segment's timestamp is not echoed
+            test_1.execute(SendSegment{}
+                               .with_ack(true)
+                               .with_seqno(seq_base + 10)
+                               .with_ackno(ack_base)
+                               .with_win(4096)
+                               .with_timestamps(1040, 5)
+                               .with_data("x"));
+            test_1.execute(ExpectOneSegment{}.with_ackno(seq_base + 6).with_timestamps(Timestamps{25, 1030}),
+                           "test 1 failed: TS.Recent taken from an out-of-order segment");
+
+            // PAWS: a segment older than TS.Recent is dropped, and answered with an ACK
+            test_1.execute(SendSegment{}
+                               .with_ack(true)
+                               .with_seqno(seq_base + 6)
+                               .with_ackno(ack_base)
+                               .with_win(4096)
+                               .with_timestamps(999, 5)
+                               .with_data("stale"));
+            test_1.execute(ExpectOneSegment{}.with_ackno(seq_base + 6).with_timestamps(Timestamps{25, 1030}),
+                           "test 1 failed: PAWS did not reject an old timestamp");
+            test_1.execute(ExpectData{}.with_data("hello"));
+            test_1.execute(ExpectUnassembledBytes{1});
+        }
+
+        // test 2: active open -> SYN offers timestamps, the peer doesn't -> no timestamps
+        {
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_2(cfg);
+
+            test_2.execute(Connect{});
+            TCPSegment seg = test_2.expect_seg(ExpectOneSegment{}.with_syn(true).with_timestamps(Timestamps{0, 0}),
+                                               "test 2 failed: SYN did not offer timestamps");
+            const WrappingInt32 isn = seg.header().seqno;
+
+            test_2.execute(
+                SendSegment{}.with_syn(true).with_ack(true).with_seqno(seq_base).with_ackno(isn + 1).with_win(4096));
+            test_2.execute(ExpectOneSegment{}.with_ack(true).with_timestamps(nullopt),
+                           "test 2 failed: timestamps sent although the peer did not offer them");
+            test_2.execute(Write{"abc"});
+            test_2.execute(ExpectOneSegment{}.with_data("abc").with_timestamps(nullopt));
+        }
+
+        // test 3: timestamps are off by default, and a peer's offer goes unanswered
+        {
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_3(TCPConfig{});
+
+            test_3.execute(Listen{});
+            test_3.execute(SendSegment{}.with_syn(true).with_seqno(seq_base).with_win(4096).with_timestamps(1000, 0));
+            test_3.execute(ExpectOneSegment{}.with_syn(true).with_ack(true).with_timestamps(nullopt),
+                           "test 3 failed: answered a timestamps offer without being configured to");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
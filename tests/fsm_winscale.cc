@@ -0,0 +1,118 @@
+#include "tcp_config.hh"
+#include "tcp_expectation.hh"
+#include "tcp_fsm_test_harness.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace std;
+using State = TCPTestHarness::State;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        TCPConfig cfg{};
+        cfg.recv_capacity = 1 << 20;  // needs a shift of 5 to be advertised in 16 bits
+        cfg.send_capacity = 1 << 20;
+
+        // test 1: listen -> peer offers scaling -> both directions scale, SYN windows don't
+        {
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_1(cfg);
+
+            test_1.execute(Listen{});
+            test_1.execute(SendSegment{}.with_syn(true).with_seqno(seq_base).with_win(4096).with_wscale(7));
+
+            TCPSegment seg = test_1.expect_seg(ExpectOneSegment{}
+                                                   .with_syn(true)
+                                                   .with_ack(true)
+                                                   .with_ackno(seq_base + 1)
+                                                   .with_win(65535)
+                                                   .with_wscale(5),
+                                               "test 1 failed: SYN/ACK did not answer the window scale offer");
+            const WrappingInt32 ack_base = seg.header().seqno;
+
+            // a window field of 100 now means 100 << 7 bytes
+            test_1.send_ack(seq_base + 1, ack_base + 1, 100);
+            test_1.execute(ExpectState{State::ESTABLISHED});
+            test_1.execute(Write{string(20000, 'x')}.with_bytes_written(20000));
+            test_1.execute(ExpectBytesInFlight{100 << 7}, "test 1 failed: peer's window was not scaled");
+            test_1.execute(ExpectSegment{}.with_win((1 << 20) >> 5).with_wscale(nullopt),
+                           "test 1 failed: advertised window was not scaled");
+        }
+
+        // test 2: listen -> peer does not offer scaling -> unscaled windows, clamped to 16 bits
+        {
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_2(cfg);
+
+            test_2.execute(Listen{});
+            test_2.send_syn(seq_base);
+
+            TCPSegment seg = test_2.expect_seg(
+                ExpectOneSegment{}.with_syn(true).with_ack(true).with_win(65535).with_wscale(nullopt),
+                "test 2 failed: SYN/ACK offered window scaling to a peer that did not");
+            const WrappingInt32 ack_base = seg.header().seqno;
+
+            test_2.send_ack(seq_base + 1, ack_base + 1, 5000);
+            test_2.execute(Write{string(20000, 'x')}.with_bytes_written(20000));
+            test_2.execute(ExpectBytesInFlight{5000}, "test 2 failed: peer's window was scaled");
+            test_2.execute(ExpectSegment{}.with_win(65535), "test 2 failed: advertised window not clamped");
+        }
+
+        // test 3: active open -> SYN offers scaling -> peer accepts
+        {
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_3(cfg);
+
+            test_3.execute(Connect{});
+            TCPSegment seg = test_3.expect_seg(ExpectOneSegment{}.with_syn(true).with_ack(false).with_wscale(5),
+                                               "test 3 failed: SYN did not offer window scaling");
+            const WrappingInt32 isn = seg.header().seqno;
+
+            test_3.execute(SendSegment{}
+                               .with_syn(true)
+                               .with_ack(true)
+                               .with_seqno(seq_base)
+                               .with_ackno(isn + 1)
+                               .with_win(60000)
+                               .with_wscale(2));
+            test_3.execute(ExpectOneSegment{}.with_ack(true).with_ackno(seq_base + 1).with_win((1 << 20) >> 5),
+                           "test 3 failed: ACK of SYN/ACK did not scale the window");
+            test_3.execute(ExpectState{State::ESTABLISHED});
+
+            test_3.send_ack(seq_base + 1, isn + 1, 1000);
+            test_3.execute(Write{string(20000, 'x')}.with_bytes_written(20000));
+            test_3.execute(ExpectBytesInFlight{1000 << 2}, "test 3 failed: peer's window was not scaled");
+        }
+
+        // test 4: scaling disabled -> no option even when the peer offers it
+        {
+            TCPConfig cfg_off = cfg;
+            cfg_off.window_scaling = false;
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_4(cfg_off);
+
+            test_4.execute(Listen{});
+            test_4.execute(SendSegment{}.with_syn(true).with_seqno(seq_base).with_win(4096).with_wscale(7));
+            TCPSegment seg = test_4.expect_seg(ExpectOneSegment{}.with_syn(true).with_ack(true).with_wscale(nullopt),
+                                               "test 4 failed: window scaling offered although disabled");
+
+            test_4.send_ack(seq_base + 1, seg.header().seqno + 1, 100);
+            test_4.execute(Write{string(20000, 'x')}.with_bytes_written(20000));
+            test_4.execute(ExpectBytesInFlight{100}, "test 4 failed: peer's window was scaled");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
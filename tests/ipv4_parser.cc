@@ -229,11 +229,11 @@ int main(int argc, char **argv) {
                 TCPHeader &tcp_hdr_copy = tcp_seg_copy.header();
                 tcp_hdr_copy = tcp_hdr_orig;
 
-                // fix up packets to remove IPv4 and TCP header extensions
+                // fix up packets to remove IPv4 header extensions and unknown TCP options
                 ipv4_hdr_copy.len -= 4 * ipv4_hdr_orig.hlen - IPv4Header::LENGTH;
                 ipv4_hdr_copy.hlen = 5;
-                ipv4_hdr_copy.len -= 4 * tcp_hdr_orig.doff - TCPHeader::LENGTH;
-                tcp_hdr_copy.doff = 5;
+                ipv4_hdr_copy.len -= 4 * tcp_hdr_orig.doff - tcp_hdr_copy.length();
+                tcp_hdr_copy.doff = tcp_hdr_copy.length() / 4;
             }  // ipv4_hdr_{orig,copy}, tcp_hdr_{orig,copy} go out of scope
 
             if (!compare_ip_headers_nolen(ip_dgram.header(), ip_dgram_copy.header())) {
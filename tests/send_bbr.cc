@@ -0,0 +1,217 @@
+#include "congestion_control.hh"
+#include "sender_harness.hh"
+#include "tcp_receiver.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static constexpr size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+
+static void check(const bool condition, const string &what) {
+    if (not condition) {
+        throw runtime_error(what);
+    }
+}
+
+//! Feeds a BBR controller one rate sample per round trip of `rtt` ms, as a sender paced at `rate` would take
+struct RoundTrips {
+    BBR &bbr;
+    uint64_t rtt;
+    uint64_t now{0};
+    uint64_t total_delivered{0};
+
+    void round(const uint64_t rate, const uint64_t bytes_in_flight, const uint64_t elapsed = 0) {
+        const uint64_t delivered = rate * rtt / 1000;
+        const uint64_t prior_delivered = total_delivered;
+        total_delivered += delivered;
+        now += elapsed ? elapsed : rtt;
+        bbr.on_rate_sample(
+            {rate, delivered, rtt, prior_delivered, total_delivered, delivered, rtt, bytes_in_flight, now, false});
+    }
+};
+
+//! Run `rounds` round trips of `rtt` ms in which every `drop_every`th segment of new data is lost, acknowledging
+//! (and SACKing) what arrives at the end of the round, and return the bytes delivered in order
+static uint64_t lossy_rounds(
+    TCPSender &sender, const unsigned rounds, const size_t rtt, const uint64_t window, const unsigned drop_every) {
+    TCPReceiver receiver{1 << 20};
+    sender.fill_window();
+    receiver.segment_received(sender.segments_out().front());
+    sender.segments_out().pop();
+    sender.ack_received(receiver.ackno().value(), window);
+
+    uint64_t delivered = 0;
+    unsigned new_segments = 0;
+    set<uint32_t> sent;
+    for (unsigned round = 0; round < rounds; ++round) {
+        sender.stream_in().write(string(sender.stream_in().remaining_capacity(), 'x'));
+        sender.fill_window();
+        vector<TCPSegment> batch;
+        while (not sender.segments_out().empty()) {
+            batch.push_back(sender.segments_out().front());
+            sender.segments_out().pop();
+        }
+        sender.tick(rtt);
+
+        for (const TCPSegment &seg : batch) {
+            if (sent.insert(seg.header().seqno.raw_value()).second and ++new_segments % drop_every == 0) {
+                continue;
+            }
+            receiver.segment_received(seg);
+            TCPHeader ack;
+            receiver.fill_sack_blocks(ack, 3);
+            sender.sack_received(ack);
+            sender.ack_received(receiver.ackno().value(), window);
+        }
+        delivered += receiver.stream_out().buffer_size();
+        receiver.stream_out().pop_output(receiver.stream_out().buffer_size());
+    }
+    return delivered;
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            // the bottleneck takes 400 kB/s with a 100 ms RTprop: a BDP of 40 kB
+            BBR bbr{MSS};
+            RoundTrips path{bbr, 100};
+            for (const uint64_t rate : {100000, 200000, 400000}) {
+                path.round(rate, 100000);
+                check(bbr.mode() == BBR::Mode::Startup, "Startup ended while the delivery rate doubled");
+            }
+            check(bbr.pacing_rate() == static_cast<uint64_t>(BBR::HIGH_GAIN * 400000), "Startup pacing gain");
+            check(bbr.ssthresh() == numeric_limits<uint64_t>::max(), "BBR set ssthresh");
+
+            // three rounds without 25% growth fill the pipe; the queue Startup built is then drained
+            path.round(400000, 100000);
+            path.round(450000, 100000);
+            check(bbr.mode() == BBR::Mode::Startup, "Startup ended before three rounds without growth");
+            path.round(450000, 100000);
+            check(bbr.mode() == BBR::Mode::Drain, "Startup didn't end");
+            check(bbr.btlbw() == 450000, "BtlBw is the largest delivery rate");
+            check(bbr.pacing_rate() == static_cast<uint64_t>(1 / BBR::HIGH_GAIN * 450000), "Drain pacing gain");
+            path.round(450000, 40000);
+            check(bbr.mode() == BBR::Mode::ProbeBW, "Drain didn't end with the flight at the BDP");
+            check(bbr.pacing_rate() == 450000, "ProbeBW cruises at BtlBw");
+            check(bbr.cwnd() == 2 * 45000, "cwnd is twice the BDP");
+
+            // a round trip later, ProbeBW probes for more bandwidth, then drains what the probe queued
+            path.round(450000, 40000, 101);
+            check(bbr.pacing_rate() == static_cast<uint64_t>(1.25 * 450000), "ProbeBW probes upwards");
+            path.round(450000, 50000, 101);
+            check(bbr.pacing_rate() == static_cast<uint64_t>(0.75 * 450000), "ProbeBW drains after probing");
+            path.round(450000, 45000, 50);
+            check(bbr.pacing_rate() == 450000, "the draining phase ends once the flight is down to the BDP");
+
+            // losses don't move the model
+            bbr.on_loss(90000, path.now);
+            check(bbr.cwnd() == 2 * 45000, "a loss lowered cwnd");
+            bbr.enter_recovery(60000, path.now, true);
+            check(bbr.cwnd() == 60000, "recovery conserves the flight");
+            bbr.exit_recovery(50000);
+            check(bbr.cwnd() == 2 * 45000, "cwnd is restored after recovery");
+            check(bbr.pacing_rate() == 450000, "a loss changed the pacing rate");
+
+            // the bandwidth estimate expires ten round trips after it was measured
+            for (unsigned i = 0; i < BBR::BTLBW_FILTER_ROUNDS; ++i) {
+                path.round(300000, 30000);
+            }
+            check(bbr.btlbw() == 300000, "BtlBw didn't expire");
+        }
+
+        {
+            BBR bbr{MSS};
+            RoundTrips path{bbr, 100};
+            for (const uint64_t rate : {100000, 200000, 400000, 400000, 400000, 400000}) {
+                path.round(rate, 20000);
+            }
+            check(bbr.mode() == BBR::Mode::ProbeBW, "the pipe didn't fill");
+            const uint64_t cwnd = bbr.cwnd();
+            const uint64_t measured = path.now;
+
+            // ten seconds without a shorter RTT: shrink the flight to measure RTprop again
+            path.rtt = 120;
+            while (path.now + path.rtt <= measured + BBR::RTPROP_FILTER_MS) {
+                path.round(400000, 40000);
+                check(bbr.mode() == BBR::Mode::ProbeBW, "ProbeRTT started early");
+            }
+            path.round(400000, 40000);
+            check(bbr.mode() == BBR::Mode::ProbeRTT, "ProbeRTT didn't start");
+            check(bbr.cwnd() == BBR::MIN_CWND_SEGMENTS * MSS, "ProbeRTT window");
+            check(bbr.rtprop() == 120, "RTprop wasn't renewed");
+            path.round(400000, BBR::MIN_CWND_SEGMENTS * MSS, 10);
+            path.round(400000, BBR::MIN_CWND_SEGMENTS * MSS, BBR::PROBE_RTT_MS - 10);
+            check(bbr.mode() == BBR::Mode::ProbeRTT, "ProbeRTT ended early");
+            path.round(400000, BBR::MIN_CWND_SEGMENTS * MSS, 10);
+            check(bbr.mode() == BBR::Mode::ProbeBW, "ProbeRTT didn't end");
+            check(bbr.cwnd() >= cwnd, "cwnd wasn't restored after ProbeRTT");
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = CongestionControl::Algorithm::BBR;
+            const auto seg = [&](const unsigned i) { return isn + 1 + i * MSS; };
+
+            TCPSenderTestHarness test{"BBR paces new data at the delivery rate it measured", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{100});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(60000));
+            test.execute(WriteBytes{string(MSS, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(0)));
+            // 1 kB delivered in 100 ms: 10 kB/s, paced at 2.885 times that, a segment every 34.7 ms
+            test.execute(Tick{100});
+            test.execute(AckReceived{seg(1)}.with_win(60000));
+            test.execute(WriteBytes{string(3 * MSS, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(1)));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectTimeUntilNextSend{35});
+            test.execute(Tick{35});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(2)));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            // 5% random loss: NewReno halves its window at each loss, BBR keeps to its model
+            const size_t rtt = 100;
+            const uint64_t window = 64000;
+            uint64_t delivered[2] = {};
+            const CongestionControl::Algorithm algorithms[2] = {CongestionControl::Algorithm::NewReno,
+                                                                CongestionControl::Algorithm::BBR};
+            for (unsigned i = 0; i < 2; ++i) {
+                TCPConfig cfg;
+                cfg.fixed_isn = WrappingInt32(rd());
+                cfg.congestion_control = algorithms[i];
+                cfg.fast_retransmit = true;
+                cfg.sack = true;
+                cfg.send_capacity = 1 << 20;
+                TCPSender sender{cfg};
+                delivered[i] = lossy_rounds(sender, 40, rtt, window, 20);
+                check(sender.consecutive_retransmissions() == 0, "the retransmission timer fired");
+            }
+            if (delivered[1] <= 2 * delivered[0]) {
+                throw runtime_error("BBR delivered " + to_string(delivered[1]) + " bytes under random loss, NewReno " +
+                                    to_string(delivered[0]));
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
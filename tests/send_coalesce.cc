@@ -0,0 +1,91 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+static constexpr size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"With no-delay every write goes out at once", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes{"GET / HTTP/1.1\r\n"});
+            test.execute(ExpectSegment{}.with_data("GET / HTTP/1.1\r\n").with_seqno(isn + 1));
+            test.execute(WriteBytes{"Host: x\r\n"});
+            test.execute(ExpectSegment{}.with_data("Host: x\r\n").with_seqno(isn + 17));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.no_delay = false;
+
+            TCPSenderTestHarness test{"Nagle's algorithm coalesces small writes while data is unacknowledged", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes{"abc"});
+            test.execute(ExpectSegment{}.with_data("abc").with_seqno(isn + 1));
+            test.execute(WriteBytes{"def"});
+            test.execute(WriteBytes{"ghi"});
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 4}}.with_win(10000));
+            test.execute(ExpectSegment{}.with_data("defghi").with_seqno(isn + 4));
+            test.execute(ExpectNoSegment{});
+
+            // full segments are never held, only the short tail behind them
+            test.execute(WriteBytes{string(2 * MSS + 10, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 10));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 10 + MSS));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 10 + MSS}}.with_win(10000));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 10 + 2 * MSS}}.with_win(10000));
+            test.execute(ExpectSegment{}.with_payload_size(10).with_seqno(isn + 10 + 2 * MSS));
+
+            // closing the stream sends the tail with the FIN
+            test.execute(WriteBytes{"end"});
+            test.execute(ExpectNoSegment{});
+            test.execute(Close{});
+            test.execute(ExpectSegment{}.with_data("end").with_fin(true).with_seqno(isn + 20 + 2 * MSS));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"A corked sender only sends full segments", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(SetCork{true});
+            test.execute(WriteBytes{string(MSS / 2, 'a')});
+            test.execute(ExpectNoSegment{});
+            test.execute(WriteBytes{string(MSS, 'b')});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1));
+            test.execute(ExpectNoSegment{});
+            test.execute(SetCork{false});
+            test.execute(ExpectSegment{}.with_data(string(MSS / 2, 'b')).with_seqno(isn + 1 + MSS));
+            test.execute(ExpectNoSegment{});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
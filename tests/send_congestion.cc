@@ -0,0 +1,155 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static constexpr size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+static constexpr size_t NO_SSTHRESH = numeric_limits<size_t>::max();
+
+static constexpr uint64_t LARGE_WINDOW = 1 << 24;
+
+//! Run `rounds` round trips of `rtt` ms over a lossless path with a large receive window,
+//! acknowledging each segment sent in the round at its end, and return the congestion window
+static size_t run_rounds(TCPSender &sender, const unsigned rounds, const size_t rtt) {
+    for (unsigned round = 0; round < rounds; ++round) {
+        sender.stream_in().write(string(sender.stream_in().remaining_capacity(), 'x'));
+        sender.fill_window();
+        vector<WrappingInt32> acknos;
+        while (not sender.segments_out().empty()) {
+            const TCPSegment &seg = sender.segments_out().front();
+            acknos.push_back(seg.header().seqno + seg.length_in_sequence_space());
+            sender.segments_out().pop();
+        }
+        sender.tick(rtt);
+        for (const auto ackno : acknos) {
+            sender.ack_received(ackno, LARGE_WINDOW);
+        }
+    }
+    return sender.congestion_window();
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"No congestion control: the receiver's window is filled", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(30000));
+            test.execute(WriteBytes{string(30000, 'x')});
+            test.execute(ExpectBytesInFlight{30000});
+            test.execute(ExpectCongestionWindow{NO_SSTHRESH}.with_ssthresh(NO_SSTHRESH));
+        }
+
+        for (const auto algorithm : {CongestionControl::Algorithm::NewReno, CongestionControl::Algorithm::Cubic}) {
+            const string name = algorithm == CongestionControl::Algorithm::NewReno ? "NewReno" : "CUBIC";
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = algorithm;
+
+            TCPSenderTestHarness test{name + ": initial window, then slow start", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(60000));
+            test.execute(ExpectCongestionWindow{10 * MSS}.with_ssthresh(NO_SSTHRESH));
+            test.execute(WriteBytes{string(30000, 'x')});
+            for (unsigned i = 0; i < 10; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + i * MSS));
+            }
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{10 * MSS});
+
+            // one MSS of growth per ACK, whatever it covers: 11 MSS allowed, 8 outstanding
+            test.execute(AckReceived{WrappingInt32{isn + 1 + 2 * MSS}}.with_win(60000));
+            test.execute(ExpectCongestionWindow{11 * MSS});
+            for (unsigned i = 10; i < 13; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + i * MSS));
+            }
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{11 * MSS});
+        }
+
+        for (const auto algorithm : {CongestionControl::Algorithm::NewReno, CongestionControl::Algorithm::Cubic}) {
+            const string name = algorithm == CongestionControl::Algorithm::NewReno ? "NewReno" : "CUBIC";
+            const size_t ssthresh = algorithm == CongestionControl::Algorithm::NewReno ? 5 * MSS : 7 * MSS;
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = algorithm;
+
+            TCPSenderTestHarness test{name + ": a timeout collapses the window to one segment", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(60000));
+            test.execute(WriteBytes{string(30000, 'x')});
+            for (unsigned i = 0; i < 10; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS));
+            }
+            test.execute(Tick{cfg.rt_timeout});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectCongestionWindow{MSS}.with_ssthresh(ssthresh));
+
+            // everything arrives: slow start again, from one segment
+            test.execute(AckReceived{WrappingInt32{isn + 1 + 10 * MSS}}.with_win(60000));
+            test.execute(ExpectCongestionWindow{2 * MSS}.with_ssthresh(ssthresh));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + 10 * MSS));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + 11 * MSS));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            // after the same loss, CUBIC regrows its window faster than NewReno on a long-RTT path
+            const size_t rtt = 100;
+            size_t cwnd[2] = {};
+            const CongestionControl::Algorithm algorithms[2] = {CongestionControl::Algorithm::NewReno,
+                                                                CongestionControl::Algorithm::Cubic};
+            for (unsigned i = 0; i < 2; ++i) {
+                TCPConfig cfg;
+                WrappingInt32 isn(rd());
+                cfg.fixed_isn = isn;
+                cfg.congestion_control = algorithms[i];
+                cfg.send_capacity = 1 << 20;
+                TCPSender sender{cfg};
+                sender.fill_window();
+                sender.segments_out().pop();
+                sender.ack_received(isn + 1, LARGE_WINDOW);
+
+                run_rounds(sender, 3, rtt);  // slow start up to 80 segments
+
+                // lose a round: the retransmission timer fires, then everything is acknowledged
+                sender.stream_in().write(string(sender.stream_in().remaining_capacity(), 'x'));
+                sender.fill_window();
+                sender.tick(cfg.rt_timeout);
+                sender.ack_received(wrap(sender.next_seqno_absolute(), isn), LARGE_WINDOW);
+
+                cwnd[i] = run_rounds(sender, 40, rtt);
+                if (cwnd[i] <= sender.slow_start_threshold()) {
+                    throw runtime_error("congestion window did not grow past ssthresh after a loss");
+                }
+            }
+            if (cwnd[1] <= cwnd[0]) {
+                throw runtime_error("CUBIC (" + to_string(cwnd[1]) + " bytes) did not regrow faster than NewReno (" +
+                                    to_string(cwnd[0]) + " bytes)");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -298,6 +298,21 @@ int main() {
             test.execute(ExpectState{TCPSenderStateSummary::FIN_ACKED});
         }
 
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.mss = 16 * TCPConfig::MAX_PAYLOAD_SIZE;
+
+            TCPSenderTestHarness test{"A configured MSS sizes the segments", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(40000));
+            test.execute(WriteBytes{string(cfg.mss + 100, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(cfg.mss).with_seqno(isn + 1));
+            test.execute(ExpectSegment{}.with_payload_size(100).with_seqno(isn + 1 + cfg.mss));
+            test.execute(ExpectNoSegment{});
+        }
+
         {
             TCPConfig cfg;
             WrappingInt32 isn(rd());
@@ -0,0 +1,119 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.mss = 4000;
+
+            TCPSenderTestHarness test{"Without MTU probing segments are sized to the MSS", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(20000));
+            test.execute(WriteBytes{string(5000, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(4000).with_seqno(isn + 1));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 4001));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.mss = 4000;
+            cfg.mtu_probing = true;
+            cfg.path_mss = 1000;
+
+            TCPSenderTestHarness test{"Delivered probes raise the segment size, a lost one is resent in pieces", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(20000));
+
+            // the first probe goes halfway from 1000 to 4000, the rest still go in 1000-byte segments
+            uint32_t seqno = 1;
+            test.execute(WriteBytes{string(5000, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(2500).with_seqno(isn + seqno));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + seqno + 2500));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + seqno + 3500));
+            test.execute(ExpectSegment{}.with_payload_size(500).with_seqno(isn + seqno + 4500));
+            test.execute(ExpectNoSegment{});
+            seqno += 5000;
+            test.execute(AckReceived{WrappingInt32{isn + seqno}}.with_win(20000));
+
+            // 2500 got through: it is the new segment size, and the next probe goes halfway from there
+            test.execute(WriteBytes{string(6000, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(3250).with_seqno(isn + seqno));
+            test.execute(ExpectSegment{}.with_payload_size(2500).with_seqno(isn + seqno + 3250));
+            test.execute(ExpectSegment{}.with_payload_size(250).with_seqno(isn + seqno + 5750));
+            test.execute(ExpectNoSegment{});
+            seqno += 6000;
+            test.execute(AckReceived{WrappingInt32{isn + seqno}}.with_win(20000));
+
+            // a probe of 3625 is lost: its bytes are resent in 3250-byte pieces
+            test.execute(WriteBytes{string(4000, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(3625).with_seqno(isn + seqno));
+            test.execute(ExpectSegment{}.with_payload_size(375).with_seqno(isn + seqno + 3625));
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{cfg.rt_timeout});
+            test.execute(ExpectSegment{}.with_payload_size(3250).with_seqno(isn + seqno));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + seqno + 3250}}.with_win(20000));
+            test.execute(Tick{cfg.rt_timeout});
+            test.execute(ExpectSegment{}.with_payload_size(375).with_seqno(isn + seqno + 3250));
+            seqno += 4000;
+            test.execute(AckReceived{WrappingInt32{isn + seqno}}.with_win(20000));
+            test.execute(ExpectBytesInFlight{0});
+
+            // the search goes on below the size that was lost
+            test.execute(WriteBytes{string(4000, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(3437).with_seqno(isn + seqno));
+            test.execute(ExpectSegment{}.with_payload_size(563).with_seqno(isn + seqno + 3437));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.mss = 4000;
+            cfg.mtu_probing = true;
+            cfg.path_mss = 1000;
+            cfg.fast_retransmit = true;
+
+            TCPSenderTestHarness test{"A probe lost to SACK recovery is resent in pieces", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(20000));
+            test.execute(WriteBytes{string(6500, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(2500).with_seqno(isn + 1));
+            for (unsigned i = 0; i < 4; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 2501 + i * 1000));
+            }
+            test.execute(ExpectNoSegment{});
+
+            // everything after the probe is SACKed
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(20000).with_sack(isn + 2501, isn + 6501));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1001));
+            test.execute(ExpectSegment{}.with_payload_size(500).with_seqno(isn + 2001));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 6501}}.with_win(20000));
+            test.execute(ExpectBytesInFlight{0});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
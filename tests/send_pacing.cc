@@ -0,0 +1,102 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+static constexpr size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.pacing = true;
+
+            TCPSenderTestHarness test{"Without an RTT sample nothing is paced", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes{string(4 * MSS, 'x')});
+            for (unsigned i = 0; i < 4; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + i * MSS));
+            }
+            test.execute(ExpectTimeUntilNextSend{{}});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.pacing = true;
+            cfg.pacing_rate = 1000 * MSS;  // one segment per millisecond
+
+            TCPSenderTestHarness test{"A fixed pacing rate releases one segment per millisecond", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes{string(5 * MSS, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectTimeUntilNextSend{1});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + MSS));
+            test.execute(ExpectNoSegment{});
+
+            // a coarser tick releases what the rate allowed over it, and no more
+            test.execute(Tick{3});
+            for (unsigned i = 2; i < 5; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + i * MSS));
+            }
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectTimeUntilNextSend{{}});
+
+            // time spent idle earns no burst
+            test.execute(AckReceived{WrappingInt32{isn + 1 + 5 * MSS}}.with_win(10000));
+            test.execute(Tick{100});
+            test.execute(WriteBytes{string(3 * MSS, 'y')});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + 5 * MSS));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectTimeUntilNextSend{1});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + 6 * MSS));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.pacing = true;
+
+            TCPSenderTestHarness test{"The rate follows the window and SRTT", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{10});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(ExpectRetransmissionTimeout{cfg.rt_timeout}.with_srtt(10));
+
+            // 1.2 * 10000 bytes per 10 ms: a segment every 833 us
+            test.execute(WriteBytes{string(4 * MSS, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectTimeUntilNextSend{1});
+            for (unsigned i = 1; i < 4; ++i) {
+                test.execute(Tick{1});
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + i * MSS));
+                test.execute(ExpectNoSegment{});
+            }
+            test.execute(ExpectTimeUntilNextSend{{}});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,109 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.rt_timeout = 100;
+            cfg.rto_max = 400;
+            cfg.persist_backoff = true;
+
+            TCPSenderTestHarness test{"Zero-window probes back off exponentially, up to rto_max", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(WriteBytes("abc"));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(0));
+            test.execute(ExpectSegment{}.with_payload_size(1).with_data("a").with_seqno(isn + 1));
+            for (const unsigned interval : {100, 200, 400, 400}) {
+                test.execute(Tick{interval - 1});
+                test.execute(ExpectNoSegment{});
+                test.execute(Tick{1});
+                test.execute(ExpectSegment{}.with_payload_size(1).with_data("a").with_seqno(isn + 1));
+            }
+            test.execute(ExpectZeroWindowTime{1100, 1});
+
+            // the window opens: the probe and what follows it are left to the retransmission timer
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10));
+            test.execute(ExpectSegment{}.with_payload_size(2).with_data("bc").with_seqno(isn + 2));
+            test.execute(ExpectZeroWindowTime{1100, 1});
+            test.execute(Tick{99});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(1).with_data("a").with_seqno(isn + 1));
+            test.execute(AckReceived{WrappingInt32{isn + 4}}.with_win(0));
+            test.execute(Tick{50});
+            test.execute(ExpectZeroWindowTime{1150, 2});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.rt_timeout = 100;
+            cfg.rto_max = 400;
+            cfg.persist_backoff = true;
+
+            TCPSenderTestHarness test{"The connection is kept for as long as the peer answers the probes", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(WriteBytes("abc"));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(0));
+            test.execute(ExpectSegment{}.with_payload_size(1).with_data("a").with_seqno(isn + 1));
+            for (unsigned i = 0; i < 4 * TCPConfig::MAX_RETX_ATTEMPTS; ++i) {
+                test.execute(Tick{400}.with_max_retx_exceeded(false));
+                test.execute(ExpectSegment{}.with_payload_size(1).with_data("a").with_seqno(isn + 1));
+                test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(0));
+            }
+
+            test.execute(ExpectNoSegment{});
+            for (unsigned i = 0; i < TCPConfig::MAX_RETX_ATTEMPTS; ++i) {
+                test.execute(Tick{400}.with_max_retx_exceeded(false));
+                test.execute(ExpectSegment{}.with_payload_size(1).with_data("a").with_seqno(isn + 1));
+            }
+            // the peer has gone quiet
+            test.execute(Tick{400}.with_max_retx_exceeded(true));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.rt_timeout = 100;
+
+            TCPSenderTestHarness test{"Without backoff, probes go out every RTO, and unanswered ones still count", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(WriteBytes("abc"));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(0));
+            test.execute(ExpectSegment{}.with_payload_size(1).with_data("a").with_seqno(isn + 1));
+            for (unsigned i = 0; i < 2 * TCPConfig::MAX_RETX_ATTEMPTS; ++i) {
+                test.execute(Tick{100}.with_max_retx_exceeded(false));
+                test.execute(ExpectSegment{}.with_payload_size(1).with_data("a").with_seqno(isn + 1));
+                test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(0));
+            }
+            test.execute(ExpectZeroWindowTime{1600, 1});
+
+            // the peer has gone quiet
+            for (unsigned i = 0; i < TCPConfig::MAX_RETX_ATTEMPTS; ++i) {
+                test.execute(Tick{100}.with_max_retx_exceeded(false));
+                test.execute(ExpectSegment{}.with_payload_size(1).with_data("a").with_seqno(isn + 1));
+            }
+            test.execute(Tick{100}.with_max_retx_exceeded(true));
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
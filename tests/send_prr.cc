@@ -0,0 +1,191 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+static constexpr size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // ten segments in flight, the first six lost: recovery begins with little left in the network
+        for (const bool prr : {true, false}) {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+            cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+            cfg.prr = prr;
+            // sequence number of the first byte of data segment i
+            const auto seg = [&](const unsigned i) { return isn + 1 + i * MSS; };
+
+            TCPSenderTestHarness test{prr ? "PRR lets a heavy loss out no faster than slow start"
+                                          : "Without PRR, a heavy loss lets the pipe refill to ssthresh at once",
+                                      cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(60000));
+            test.execute(WriteBytes{string(10 * MSS, 'x')});
+            for (unsigned i = 0; i < 10; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(i)));
+            }
+            test.execute(AckReceived{seg(0)}.with_win(60000).with_sack(seg(6), seg(7)));
+            test.execute(AckReceived{seg(0)}.with_win(60000).with_sack(seg(6), seg(8)));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{seg(0)}.with_win(60000).with_sack(seg(6), seg(9)));
+            test.execute(ExpectCongestionWindow{5 * MSS}.with_ssthresh(5 * MSS));
+            if (prr) {
+                // one segment was delivered: it and one more may go out
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(0)));
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(1)));
+                test.execute(ExpectNoSegment{});
+                test.execute(AckReceived{seg(0)}.with_win(60000).with_sack(seg(6), seg(10)));
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(2)));
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(3)));
+                test.execute(ExpectNoSegment{});
+            } else {
+                for (unsigned i = 0; i < 4; ++i) {
+                    test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(i)));
+                }
+                test.execute(ExpectNoSegment{});
+                test.execute(AckReceived{seg(0)}.with_win(60000).with_sack(seg(6), seg(10)));
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(4)));
+                test.execute(ExpectNoSegment{});
+            }
+            // segments 0 and 1 arrive
+            test.execute(AckReceived{seg(2)}.with_win(60000).with_sack(seg(6), seg(10)));
+            if (prr) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(4)));
+            }
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(5)));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{seg(10)}.with_win(60000));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{0});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+            cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+            cfg.prr = true;
+            const auto seg = [&](const unsigned i) { return isn + 1 + i * MSS; };
+
+            TCPSenderTestHarness test{"PRR sends new data in proportion to what is delivered", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(60000));
+            test.execute(WriteBytes{string(14 * MSS, 'x')});
+            for (unsigned i = 0; i < 10; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(i)));
+            }
+            test.execute(AckReceived{seg(0)}.with_win(60000).with_sack(seg(1), seg(2)));
+            test.execute(AckReceived{seg(0)}.with_win(60000).with_sack(seg(1), seg(3)));
+            test.execute(AckReceived{seg(0)}.with_win(60000).with_sack(seg(1), seg(4)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(0)));
+            test.execute(ExpectNoSegment{});
+            // pipe comes down to ssthresh first
+            test.execute(AckReceived{seg(0)}.with_win(60000).with_sack(seg(1), seg(5)));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{seg(0)}.with_win(60000).with_sack(seg(1), seg(6)));
+            test.execute(ExpectNoSegment{});
+            for (unsigned i = 0; i < 3; ++i) {
+                test.execute(AckReceived{seg(0)}.with_win(60000).with_sack(seg(1), seg(7 + i)));
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(10 + i)));
+                test.execute(ExpectNoSegment{});
+            }
+            test.execute(AckReceived{seg(13)}.with_win(60000));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(13)));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+            cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+            cfg.limited_transmit = true;
+            const auto seg = [&](const unsigned i) { return isn + 1 + i * MSS; };
+
+            TCPSenderTestHarness test{"Limited Transmit sends a new segment on each of the first two duplicates", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(60000));
+            test.execute(WriteBytes{string(13 * MSS, 'x')});
+            for (unsigned i = 0; i < 10; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(i)));
+            }
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{seg(0)}.with_win(60000));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(10)));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{seg(0)}.with_win(60000));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(11)));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{seg(0)}.with_win(60000));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(0)));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectCongestionWindow{8 * MSS}.with_ssthresh(5 * MSS));
+        }
+
+        for (const bool limited_transmit : {true, false}) {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.rt_timeout = 1000;
+            cfg.fast_retransmit = true;
+            cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+            cfg.limited_transmit = limited_transmit;
+            const auto seg = [&](const unsigned i) { return isn + 1 + i * MSS; };
+
+            TCPSenderTestHarness test{limited_transmit
+                                          ? "With Limited Transmit, a two-segment window recovers without a timeout"
+                                          : "Without Limited Transmit, a two-segment window waits for the timer",
+                                      cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(60000));
+            // a timeout brings the window down to a single segment
+            test.execute(WriteBytes{string(MSS, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(0)));
+            test.execute(Tick{1000});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(0)));
+            test.execute(AckReceived{seg(1)}.with_win(60000));
+            test.execute(ExpectCongestionWindow{2 * MSS});
+
+            // a small reply, whose first segment is lost
+            test.execute(WriteBytes{string(4 * MSS, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(1)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(2)));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{seg(1)}.with_win(60000));
+            if (limited_transmit) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(3)));
+                test.execute(AckReceived{seg(1)}.with_win(60000));
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(4)));
+                test.execute(AckReceived{seg(1)}.with_win(60000));
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(1)));
+                test.execute(ExpectNoSegment{});
+                test.execute(AckReceived{seg(5)}.with_win(60000));
+                test.execute(ExpectBytesInFlight{0});
+            } else {
+                test.execute(ExpectNoSegment{});
+                test.execute(Tick{999});
+                test.execute(ExpectNoSegment{});
+                test.execute(Tick{1});
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(1)));
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,179 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+static constexpr size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+            cfg.rack = true;
+            // sequence number of the first byte of data segment i
+            const auto seg = [&](const unsigned i) { return isn + 1 + i * MSS; };
+
+            TCPSenderTestHarness test{"A segment is lost a round trip plus the reordering window after a later one",
+                                      cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{40});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes{string(2 * MSS, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(0)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(1)));
+            // one segment SACKed would never reach DupThresh; RACK waits the round trip plus min_rtt / 4
+            test.execute(Tick{40});
+            test.execute(AckReceived{seg(0)}.with_win(10000).with_sack(seg(1), seg(2)));
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{9});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(0)));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{seg(2)}.with_win(10000));
+            test.execute(ExpectBytesInFlight{0});
+            test.execute(ExpectSackedBytes{0});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+            cfg.rack = true;
+            const auto seg = [&](const unsigned i) { return isn + 1 + i * MSS; };
+
+            TCPSenderTestHarness test{"Once reordering is seen, SACKs past DupThresh wait out the reordering window",
+                                      cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{40});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes{string(2 * MSS, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(0)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(1)));
+            // segment 0 turns up late, but within the window
+            test.execute(Tick{40});
+            test.execute(AckReceived{seg(0)}.with_win(10000).with_sack(seg(1), seg(2)));
+            test.execute(Tick{5});
+            test.execute(AckReceived{seg(2)}.with_win(10000));
+            test.execute(ExpectNoSegment{});
+
+            test.execute(WriteBytes{string(5 * MSS, 'x')});
+            for (unsigned i = 2; i < 7; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(i)));
+            }
+            test.execute(Tick{40});
+            test.execute(AckReceived{seg(2)}.with_win(10000).with_sack(seg(3), seg(7)));
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{9});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(2)));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+            cfg.rack = true;
+            const auto seg = [&](const unsigned i) { return isn + 1 + i * MSS; };
+
+            TCPSenderTestHarness test{"A lost tail is probed after 2 * SRTT, and the probe's SACK exposes it", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{40});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes{string(3 * MSS, 'x')});
+            for (unsigned i = 0; i < 3; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(i)));
+            }
+            // segments 1 and 2 are lost
+            test.execute(Tick{40});
+            test.execute(AckReceived{seg(1)}.with_win(10000));
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{79});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(2)));
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{40});
+            test.execute(AckReceived{seg(1)}.with_win(10000).with_sack(seg(2), seg(3)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(1)));
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{40});
+            test.execute(AckReceived{seg(3)}.with_win(10000));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{0});
+            test.execute(Tick{1000});
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+            cfg.rack = true;
+            cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+            const auto seg = [&](const unsigned i) { return isn + 1 + i * MSS; };
+
+            TCPSenderTestHarness test{"The probe sends new data if the congestion window held some back", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{40});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(60000));
+            test.execute(WriteBytes{string(12 * MSS, 'x')});
+            for (unsigned i = 0; i < CongestionControl::INITIAL_WINDOW_SEGMENTS; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(i)));
+            }
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{79});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(10)));
+            test.execute(ExpectNoSegment{});
+            // one probe per flight
+            test.execute(Tick{100});
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+            const auto seg = [&](const unsigned i) { return isn + 1 + i * MSS; };
+
+            TCPSenderTestHarness test{"Without RACK, a tail loss waits for the retransmission timer", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{40});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes{string(3 * MSS, 'x')});
+            for (unsigned i = 0; i < 3; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(i)));
+            }
+            test.execute(Tick{40});
+            test.execute(AckReceived{seg(1)}.with_win(10000));
+            test.execute(Tick{999});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(1)));
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,143 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+static constexpr size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"Without fast retransmit, duplicate ACKs are ignored", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes{string(3 * MSS, 'x')});
+            for (unsigned i = 0; i < 3; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + i * MSS));
+            }
+            for (unsigned i = 0; i < 5; ++i) {
+                test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            }
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+
+            TCPSenderTestHarness test{"Fast retransmit on the third duplicate ACK, then partial ACKs", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes{string(5 * MSS, 'x')});
+            for (unsigned i = 0; i < 5; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + i * MSS));
+            }
+            test.execute(AckReceived{WrappingInt32{isn + 1 + MSS}}.with_win(10000));
+
+            // a changed window makes it a window update, not a duplicate
+            test.execute(AckReceived{WrappingInt32{isn + 1 + MSS}}.with_win(9000));
+            test.execute(AckReceived{WrappingInt32{isn + 1 + MSS}}.with_win(9000));
+            test.execute(AckReceived{WrappingInt32{isn + 1 + MSS}}.with_win(9000));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 1 + MSS}}.with_win(9000));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + MSS));
+            test.execute(ExpectNoSegment{});
+
+            // more duplicates don't retransmit again
+            test.execute(AckReceived{WrappingInt32{isn + 1 + MSS}}.with_win(9000));
+            test.execute(ExpectNoSegment{});
+
+            // a partial ACK: the segment it points at is resent at once
+            test.execute(AckReceived{WrappingInt32{isn + 1 + 3 * MSS}}.with_win(9000));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + 3 * MSS));
+            test.execute(ExpectNoSegment{});
+
+            // the full ACK ends recovery
+            test.execute(AckReceived{WrappingInt32{isn + 1 + 5 * MSS}}.with_win(9000));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{0});
+
+            // and the timer only runs for what is sent next
+            test.execute(WriteBytes{string(MSS, 'y')});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + 5 * MSS));
+            test.execute(Tick{cfg.rt_timeout - 1u});
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+
+            TCPSenderTestHarness test{"Duplicate ACKs for data sent before a timeout start no recovery", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes{string(2 * MSS, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + MSS));
+            test.execute(Tick{cfg.rt_timeout});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1));
+            for (unsigned i = 0; i < 3; ++i) {
+                test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            }
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+            cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+
+            TCPSenderTestHarness test{"NewReno fast recovery: window inflation and deflation", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(60000));
+            test.execute(WriteBytes{string(10 * MSS, 'x')});
+            for (unsigned i = 0; i < 10; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + i * MSS));
+            }
+            test.execute(AckReceived{WrappingInt32{isn + 1 + MSS}}.with_win(60000));
+            test.execute(ExpectCongestionWindow{11 * MSS});
+
+            for (unsigned i = 0; i < 3; ++i) {
+                test.execute(AckReceived{WrappingInt32{isn + 1 + MSS}}.with_win(60000));
+            }
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + MSS));
+            // ssthresh = FlightSize / 2, cwnd = ssthresh + 3 MSS
+            test.execute(ExpectCongestionWindow{9 * MSS / 2 + 3 * MSS}.with_ssthresh(9 * MSS / 2));
+
+            test.execute(AckReceived{WrappingInt32{isn + 1 + MSS}}.with_win(60000));
+            test.execute(ExpectCongestionWindow{9 * MSS / 2 + 4 * MSS});
+
+            // partial ACK of 4 MSS: deflate by 4 MSS, add back one
+            test.execute(AckReceived{WrappingInt32{isn + 1 + 5 * MSS}}.with_win(60000));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + 5 * MSS));
+            test.execute(ExpectCongestionWindow{9 * MSS / 2 + MSS});
+
+            // full ACK: nothing in flight, so cwnd = min(ssthresh, 2 MSS)
+            test.execute(AckReceived{WrappingInt32{isn + 1 + 10 * MSS}}.with_win(60000));
+            test.execute(ExpectCongestionWindow{2 * MSS}.with_ssthresh(9 * MSS / 2));
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,138 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.adaptive_rto = true;
+
+            TCPSenderTestHarness test{"First RTT sample sets SRTT and RTO (RFC 6298 2.2)", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(ExpectRetransmissionTimeout{cfg.rt_timeout}.with_srtt(nullopt));
+            test.execute(Tick{100});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            // SRTT = 100, RTTVAR = 50, RTO = 100 + 4 * 50
+            test.execute(ExpectRetransmissionTimeout{300}.with_srtt(100));
+
+            test.execute(WriteBytes{"abc"});
+            test.execute(ExpectSegment{}.with_payload_size(3).with_seqno(isn + 1));
+            test.execute(Tick{299});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(3).with_seqno(isn + 1));
+            test.execute(ExpectRetransmissionTimeout{600});
+
+            // the retransmitted segment is acknowledged: no sample, but the timer restarts at the RTO
+            test.execute(Tick{20});
+            test.execute(AckReceived{WrappingInt32{isn + 4}}.with_win(1000));
+            test.execute(ExpectRetransmissionTimeout{300}.with_srtt(100));
+
+            // a second sample of 200: SRTT = 112.5, RTTVAR = 62.5, RTO = ceil(112.5 + 250)
+            test.execute(WriteBytes{"d"});
+            test.execute(ExpectSegment{}.with_payload_size(1).with_seqno(isn + 4));
+            test.execute(Tick{200});
+            test.execute(AckReceived{WrappingInt32{isn + 5}}.with_win(1000));
+            test.execute(ExpectRetransmissionTimeout{363}.with_srtt(112.5));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.adaptive_rto = true;
+
+            TCPSenderTestHarness test{"Karn's algorithm: retransmitted segments are not timed", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{cfg.rt_timeout});
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{50});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            test.execute(ExpectRetransmissionTimeout{cfg.rt_timeout}.with_srtt(nullopt));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.adaptive_rto = true;
+
+            TCPSenderTestHarness test{"An echoed timestamp times even a retransmitted segment", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{cfg.rt_timeout});
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{50});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000).with_rtt_sample(50));
+            // SRTT = 50, RTTVAR = 25, RTO = max(rto_min, 50 + 4 * 25)
+            test.execute(ExpectRetransmissionTimeout{200}.with_srtt(50));
+
+            // a duplicate ACK acknowledges nothing new, so its timestamp is not a sample
+            test.execute(WriteBytes{"abc"});
+            test.execute(ExpectSegment{}.with_payload_size(3).with_seqno(isn + 1));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000).with_rtt_sample(5));
+            test.execute(ExpectRetransmissionTimeout{200}.with_srtt(50));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.adaptive_rto = true;
+
+            TCPSenderTestHarness test{"The RTO never drops below rto_min", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{10});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            test.execute(ExpectRetransmissionTimeout{cfg.rto_min}.with_srtt(10));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.adaptive_rto = true;
+            cfg.rto_max = 1500;
+
+            TCPSenderTestHarness test{"Exponential backoff stops at rto_max", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{cfg.rt_timeout});
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(ExpectRetransmissionTimeout{1500});
+            test.execute(Tick{1499});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(ExpectRetransmissionTimeout{1500});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"Fixed RTO: RTT is measured but the timeout stays at rt_timeout", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{100});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            test.execute(ExpectRetransmissionTimeout{cfg.rt_timeout}.with_srtt(100));
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
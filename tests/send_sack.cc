@@ -0,0 +1,139 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+static constexpr size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+            // sequence number of the first byte of data segment i
+            const auto seg = [&](const unsigned i) { return isn + 1 + i * MSS; };
+
+            TCPSenderTestHarness test{"SACK recovery retransmits each hole once it is deemed lost", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes{string(10 * MSS, 'x')});
+            for (unsigned i = 0; i < 10; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(i)));
+            }
+            // segments 1 and 4 are lost
+            test.execute(AckReceived{seg(1)}.with_win(10000));
+            test.execute(AckReceived{seg(1)}.with_win(10000).with_sack(seg(2), seg(3)));
+            test.execute(AckReceived{seg(1)}.with_win(10000).with_sack(seg(2), seg(4)));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{seg(1)}.with_win(10000).with_sack(seg(5), seg(6)).with_sack(seg(2), seg(4)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(1)));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectSackedBytes{3 * MSS});
+
+            // two segments SACKed above segment 4 are not enough to call it lost, three are
+            test.execute(AckReceived{seg(1)}.with_win(10000).with_sack(seg(5), seg(7)).with_sack(seg(2), seg(4)));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{seg(1)}.with_win(10000).with_sack(seg(5), seg(8)).with_sack(seg(2), seg(4)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(4)));
+            test.execute(ExpectNoSegment{});
+
+            // the retransmission of segment 1 arrives: nothing more to resend
+            test.execute(AckReceived{seg(4)}.with_win(10000).with_sack(seg(5), seg(8)));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectSackedBytes{3 * MSS});
+            test.execute(AckReceived{seg(4)}.with_win(10000).with_sack(seg(5), seg(10)));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{seg(10)}.with_win(10000));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{0});
+            test.execute(ExpectSackedBytes{0});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+            const auto seg = [&](const unsigned i) { return isn + 1 + i * MSS; };
+
+            TCPSenderTestHarness test{"Three segments SACKed above a hole start recovery at once", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes{string(6 * MSS, 'x')});
+            for (unsigned i = 0; i < 6; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(i)));
+            }
+            test.execute(AckReceived{seg(1)}.with_win(10000).with_sack(seg(2), seg(5)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(1)));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+            const auto seg = [&](const unsigned i) { return isn + 1 + i * MSS; };
+
+            TCPSenderTestHarness test{"A timeout discards the scoreboard", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes{string(3 * MSS, 'x')});
+            for (unsigned i = 0; i < 3; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(i)));
+            }
+            test.execute(AckReceived{seg(0)}.with_win(10000).with_sack(seg(1), seg(3)));
+            test.execute(ExpectSackedBytes{2 * MSS});
+            test.execute(Tick{cfg.rt_timeout});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(0)));
+            test.execute(ExpectSackedBytes{0});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+            cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+            const auto seg = [&](const unsigned i) { return isn + 1 + i * MSS; };
+
+            TCPSenderTestHarness test{"SACK recovery with NewReno: cwnd = ssthresh, sending limited by pipe", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(60000));
+            test.execute(WriteBytes{string(10 * MSS, 'x')});
+            for (unsigned i = 0; i < 10; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(i)));
+            }
+            test.execute(AckReceived{seg(1)}.with_win(60000));
+
+            // segments 1 and 2 are lost, 3 to 9 arrived
+            test.execute(AckReceived{seg(1)}.with_win(60000).with_sack(seg(3), seg(10)));
+            test.execute(ExpectCongestionWindow{9 * MSS / 2}.with_ssthresh(9 * MSS / 2));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(1)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(2)));
+            test.execute(ExpectNoSegment{});
+
+            // two retransmissions in the pipe leave room for 2.5 segments of new data
+            test.execute(WriteBytes{string(5 * MSS, 'y')});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(10)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(seg(11)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS / 2).with_seqno(seg(12)));
+            test.execute(ExpectNoSegment{});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
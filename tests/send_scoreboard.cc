@@ -0,0 +1,118 @@
+#include "sack_scoreboard.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+static constexpr size_t MSS = 1000;
+static constexpr unsigned NREPS = 64;
+static constexpr unsigned NSTEPS = 200;
+
+static OutstandingSegment make_segment(const uint64_t abs_seqno, const size_t length) {
+    return {Buffer{string(length, 'x')}, false, false, 0, 0, abs_seqno};
+}
+
+//! lost_prefix() as RFC 6675 defines it: scan down from the newest segment, counting what is SACKed above
+static size_t scanned_lost_prefix(const OutstandingSegments &outstanding) {
+    uint64_t sacked_above = 0;
+    unsigned sacked_segments_above = 0;
+    for (size_t i = outstanding.size(); i > 0; --i) {
+        const OutstandingSegment &segment = outstanding[i - 1];
+        if (segment.sacked) {
+            sacked_above += segment.length_in_sequence_space();
+            ++sacked_segments_above;
+        } else if (sacked_segments_above >= SackScoreboard::DUP_THRESH ||
+                   sacked_above > (SackScoreboard::DUP_THRESH - 1) * MSS) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        for (unsigned rep_no = 0; rep_no < NREPS; ++rep_no) {
+            SackScoreboard scoreboard;
+            OutstandingSegments outstanding;
+            uint64_t next_seqno = 0;
+            uint64_t newly_sacked_bytes = 0;  // marked since the last acknowledgment took them
+            for (unsigned step = 0; step < NSTEPS; ++step) {
+                const unsigned action = rd() % 16;
+                if (action < 6 || outstanding.empty()) {
+                    // send segments of up to 2 * MSS bytes, as an MTU probe may be
+                    const size_t length = 1 + rd() % (2 * MSS);
+                    outstanding.push_back(make_segment(next_seqno, length));
+                    next_seqno += length;
+                } else if (action < 13) {
+                    // SACK a block covering a few segments
+                    const size_t first = rd() % outstanding.size();
+                    const size_t last = min(outstanding.size() - 1, first + rd() % 4);
+                    size_t unmarked = 0;
+                    for (size_t i = first; i <= last; ++i) {
+                        unmarked += !outstanding[i].sacked;
+                    }
+                    size_t newly_sacked = 0;
+                    scoreboard.mark(outstanding,
+                                    outstanding[first].abs_seqno,
+                                    outstanding[last].abs_seqno + outstanding[last].length_in_sequence_space(),
+                                    [&](const OutstandingSegment &segment) {
+                                        ++newly_sacked;
+                                        newly_sacked_bytes += segment.length_in_sequence_space();
+                                    });
+                    if (newly_sacked != unmarked) {
+                        throw runtime_error("mark() reported " + to_string(newly_sacked) +
+                                            " newly SACKed segments instead of " + to_string(unmarked));
+                    }
+                } else if (action < 15) {
+                    // cumulatively acknowledge the oldest segments
+                    const uint64_t taken = scoreboard.take_newly_sacked();
+                    if (taken != newly_sacked_bytes) {
+                        throw runtime_error("take_newly_sacked() is " + to_string(taken) + " instead of " +
+                                            to_string(newly_sacked_bytes));
+                    }
+                    newly_sacked_bytes = 0;
+                    for (size_t n = 1 + rd() % 3; n > 0 && !outstanding.empty(); --n) {
+                        scoreboard.acknowledged(outstanding.front());
+                        outstanding.pop_front();
+                    }
+                } else {
+                    // reneging: what was SACKed is delivered no longer
+                    scoreboard.reset(outstanding);
+                    newly_sacked_bytes = 0;
+                }
+
+                uint64_t sacked_bytes = 0;
+                for (const OutstandingSegment &segment : outstanding) {
+                    sacked_bytes += segment.sacked ? segment.length_in_sequence_space() : 0;
+                }
+                if (scoreboard.sacked_bytes() != sacked_bytes) {
+                    throw runtime_error("sacked_bytes() is " + to_string(scoreboard.sacked_bytes()) +
+                                        " instead of " + to_string(sacked_bytes));
+                }
+                // the two prefixes may differ only by SACKed segments, which are never deemed lost
+                const size_t expected = scanned_lost_prefix(outstanding);
+                const size_t lost = scoreboard.lost_prefix(outstanding, MSS);
+                for (size_t i = 0; i < outstanding.size(); ++i) {
+                    if (!outstanding[i].sacked && (i < expected) != (i < lost)) {
+                        throw runtime_error("lost_prefix() is " + to_string(lost) + " instead of " +
+                                            to_string(expected) + " (step " + to_string(step) + ")");
+                    }
+                }
+                if ((expected == 0) != (lost == 0)) {
+                    throw runtime_error("lost_prefix() is " + to_string(lost) + " instead of " + to_string(expected));
+                }
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
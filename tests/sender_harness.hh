@@ -15,6 +15,7 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <vector>
 
 const unsigned int DEFAULT_TEST_WINDOW = 137;
 
@@ -99,6 +100,145 @@ struct ExpectBytesInFlight : public SenderExpectation {
     }
 };
 
+struct ExpectSackedBytes : public SenderExpectation {
+    size_t _n_bytes;
+
+    ExpectSackedBytes(size_t n_bytes) : _n_bytes(n_bytes) {}
+    std::string description() const { return std::to_string(_n_bytes) + " bytes SACKed"; }
+
+    void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
+        if (sender.sacked_bytes() != _n_bytes) {
+            std::ostringstream ss;
+            ss << "The TCPSender reported " << sender.sacked_bytes() << " bytes SACKed, but there was expected to be "
+               << _n_bytes << " bytes SACKed";
+            throw SenderExpectationViolation(ss.str());
+        }
+    }
+};
+
+struct ExpectZeroWindowTime : public SenderExpectation {
+    uint64_t _ms;
+    size_t _episodes;
+
+    ExpectZeroWindowTime(uint64_t ms, size_t episodes) : _ms(ms), _episodes(episodes) {}
+    std::string description() const {
+        return "the window closed " + std::to_string(_episodes) + " times, for " + std::to_string(_ms) + " ms";
+    }
+
+    void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
+        if (sender.zero_window_time() != _ms || sender.zero_window_episodes() != _episodes) {
+            std::ostringstream ss;
+            ss << "The TCPSender reported the window closed " << sender.zero_window_episodes() << " times, for "
+               << sender.zero_window_time() << " ms, but it was expected to be " << _episodes << " times, for "
+               << _ms << " ms";
+            throw SenderExpectationViolation(ss.str());
+        }
+    }
+};
+
+struct ExpectCongestionWindow : public SenderExpectation {
+    size_t _cwnd;
+    std::optional<size_t> _ssthresh{};
+
+    ExpectCongestionWindow(size_t cwnd) : _cwnd(cwnd) {}
+
+    ExpectCongestionWindow &with_ssthresh(size_t ssthresh) {
+        _ssthresh = ssthresh;
+        return *this;
+    }
+
+    std::string description() const {
+        std::ostringstream ss;
+        ss << "congestion window of " << _cwnd << " bytes";
+        if (_ssthresh.has_value()) {
+            ss << " and slow-start threshold of " << _ssthresh.value() << " bytes";
+        }
+        return ss.str();
+    }
+
+    void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
+        if (sender.congestion_window() != _cwnd) {
+            std::ostringstream ss;
+            ss << "The TCPSender reported a congestion window of " << sender.congestion_window()
+               << " bytes, but it was expected to be " << _cwnd << " bytes";
+            throw SenderExpectationViolation(ss.str());
+        }
+        if (_ssthresh.has_value() and sender.slow_start_threshold() != _ssthresh.value()) {
+            std::ostringstream ss;
+            ss << "The TCPSender reported a slow-start threshold of " << sender.slow_start_threshold()
+               << " bytes, but it was expected to be " << _ssthresh.value() << " bytes";
+            throw SenderExpectationViolation(ss.str());
+        }
+    }
+};
+
+struct ExpectRetransmissionTimeout : public SenderExpectation {
+    unsigned int _rto;
+    std::optional<std::optional<double>> _srtt{};
+
+    ExpectRetransmissionTimeout(unsigned int rto) : _rto(rto) {}
+
+    //! expect a smoothed RTT of `srtt` ms, or no measurement at all if empty
+    ExpectRetransmissionTimeout &with_srtt(std::optional<double> srtt) {
+        _srtt = srtt;
+        return *this;
+    }
+
+    std::string description() const {
+        std::ostringstream ss;
+        ss << "retransmission timeout of " << _rto << " ms";
+        if (_srtt.has_value()) {
+            if (_srtt.value().has_value()) {
+                ss << " and smoothed RTT of " << _srtt.value().value() << " ms";
+            } else {
+                ss << " and no RTT measurement";
+            }
+        }
+        return ss.str();
+    }
+
+    void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
+        if (sender.retransmission_timeout() != _rto) {
+            std::ostringstream ss;
+            ss << "The TCPSender reported a retransmission timeout of " << sender.retransmission_timeout()
+               << " ms, but it was expected to be " << _rto << " ms";
+            throw SenderExpectationViolation(ss.str());
+        }
+        if (_srtt.has_value() and sender.estimated_rtt() != _srtt.value()) {
+            std::ostringstream ss;
+            ss << "The TCPSender reported a smoothed RTT of ";
+            ss << (sender.estimated_rtt().has_value() ? std::to_string(sender.estimated_rtt().value()) : "(none)");
+            ss << " ms, but it was expected to be ";
+            ss << (_srtt.value().has_value() ? std::to_string(_srtt.value().value()) : "(none)");
+            throw SenderExpectationViolation(ss.str());
+        }
+    }
+};
+
+struct ExpectTimeUntilNextSend : public SenderExpectation {
+    std::optional<size_t> _ms;
+
+    //! expect paced data to be due in `ms` milliseconds, or nothing to be waiting on pacing if empty
+    ExpectTimeUntilNextSend(std::optional<size_t> ms) : _ms(ms) {}
+
+    std::string description() const {
+        return _ms.has_value() ? "paced data due in " + std::to_string(_ms.value()) + " ms"
+                               : "no data waiting on pacing";
+    }
+
+    void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
+        if (sender.time_until_next_send() != _ms) {
+            std::ostringstream ss;
+            ss << "The TCPSender reported paced data due in ";
+            ss << (sender.time_until_next_send().has_value() ? std::to_string(sender.time_until_next_send().value())
+                                                              : "(never)");
+            ss << " ms, but it was expected to be ";
+            ss << (_ms.has_value() ? std::to_string(_ms.value()) : "(never)");
+            throw SenderExpectationViolation(ss.str());
+        }
+    }
+};
+
 struct ExpectNoSegment : public SenderExpectation {
     ExpectNoSegment() {}
     std::string description() const { return "no (more) segments"; }
@@ -191,11 +331,19 @@ struct Tick : public SenderAction {
 struct AckReceived : public SenderAction {
     WrappingInt32 _ackno;
     std::optional<uint16_t> _window_advertisement{};
+    std::vector<TCPHeader::SackBlock> _sack{};
+    std::optional<uint64_t> _rtt_sample{};
 
     AckReceived(WrappingInt32 ackno) : _ackno(ackno) {}
     std::string description() const {
         std::ostringstream ss;
         ss << "ack " << _ackno.raw_value() << " winsize " << _window_advertisement.value_or(DEFAULT_TEST_WINDOW);
+        for (const auto &block : _sack) {
+            ss << " sack " << block.left.raw_value() << "-" << block.right.raw_value();
+        }
+        if (_rtt_sample.has_value()) {
+            ss << " echoing a timestamp " << _rtt_sample.value() << " ms old";
+        }
         return ss.str();
     }
 
@@ -204,8 +352,26 @@ struct AckReceived : public SenderAction {
         return *this;
     }
 
+    //! the acknowledgment also echoes a timestamp measuring an RTT of `rtt` ms
+    AckReceived &with_rtt_sample(uint64_t rtt) {
+        _rtt_sample = rtt;
+        return *this;
+    }
+
+    //! the acknowledgment also carries a SACK block for [left, right)
+    AckReceived &with_sack(WrappingInt32 left, WrappingInt32 right) {
+        _sack.push_back({left, right});
+        return *this;
+    }
+
     void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
-        sender.ack_received(_ackno, _window_advertisement.value_or(DEFAULT_TEST_WINDOW));
+        if (not _sack.empty()) {
+            TCPHeader header;
+            header.sack_count = _sack.size();
+            std::copy(_sack.begin(), _sack.end(), header.sack_blocks.begin());
+            sender.sack_received(header);
+        }
+        sender.ack_received(_ackno, _window_advertisement.value_or(DEFAULT_TEST_WINDOW), true, _rtt_sample);
         sender.fill_window();
     }
 };
@@ -220,6 +386,15 @@ struct Close : public SenderAction {
     }
 };
 
+struct SetCork : public SenderAction {
+    bool _corked;
+
+    SetCork(bool corked) : _corked(corked) {}
+    std::string description() const { return _corked ? "cork" : "uncork"; }
+
+    void execute(TCPSender &sender, std::queue<TCPSegment> &) const { sender.set_cork(_corked); }
+};
+
 struct ExpectSegment : public SenderExpectation {
     std::optional<bool> ack{};
     std::optional<bool> rst{};
@@ -336,7 +511,7 @@ struct ExpectSegment : public SenderExpectation {
 
     virtual std::string description() const { return "segment sent with " + segment_description(); }
 
-    void execute(TCPSender &, std::queue<TCPSegment> &segments) const {
+    void execute(TCPSender &sender, std::queue<TCPSegment> &segments) const {
         if (segments.empty()) {
             throw SegmentExpectationViolation::violated_verb("existed");
         }
@@ -367,7 +542,7 @@ struct ExpectSegment : public SenderExpectation {
             throw SegmentExpectationViolation::violated_field(
                 "payload_size", payload_size.value(), seg.payload().size());
         }
-        if (seg.payload().size() > TCPConfig::MAX_PAYLOAD_SIZE) {
+        if (seg.payload().size() > sender.mss()) {
             throw SegmentExpectationViolation("packet has length (" + std::to_string(seg.payload().size()) +
                                               ") greater than the maximum");
         }
@@ -394,7 +569,7 @@ class TCPSenderTestHarness {
   public:
     TCPSenderTestHarness(const std::string &name_, TCPConfig config)
         : outbound_segments()
-        , sender(config.send_capacity, config.rt_timeout, config.fixed_isn)
+        , sender(config)
         , steps_executed()
         , name(name_) {
         sender.fill_window();
@@ -11,6 +11,7 @@
 #include <exception>
 #include <optional>
 #include <sstream>
+#include <vector>
 
 struct TCPExpectation : public TCPTestStep {
     virtual ~TCPExpectation() {}
@@ -118,9 +119,17 @@ struct ExpectSegment : public TCPExpectation {
     std::optional<bool> rst{};
     std::optional<bool> syn{};
     std::optional<bool> fin{};
+    std::optional<bool> ece{};
+    std::optional<bool> cwr{};
+    std::optional<IPv4Header::ECN> ecn{};
     std::optional<WrappingInt32> seqno{};
     std::optional<WrappingInt32> ackno{};
     std::optional<uint16_t> win{};
+    std::optional<std::optional<uint8_t>> wscale{};
+    std::optional<std::optional<uint16_t>> mss{};
+    std::optional<std::optional<TCPHeader::Timestamps>> timestamps{};
+    std::optional<bool> sack_permitted{};
+    std::optional<std::vector<TCPHeader::SackBlock>> sack{};
     std::optional<size_t> payload_size{};
     std::optional<std::string> data{};
 
@@ -144,6 +153,22 @@ struct ExpectSegment : public TCPExpectation {
         return *this;
     }
 
+    ExpectSegment &with_ece(bool ece_) {
+        ece = ece_;
+        return *this;
+    }
+
+    ExpectSegment &with_cwr(bool cwr_) {
+        cwr = cwr_;
+        return *this;
+    }
+
+    //! the ECN codepoint the segment is to be sent with in the IP header
+    ExpectSegment &with_ecn(IPv4Header::ECN ecn_) {
+        ecn = ecn_;
+        return *this;
+    }
+
     ExpectSegment &with_no_flags() {
         ack = false;
         rst = false;
@@ -171,6 +196,32 @@ struct ExpectSegment : public TCPExpectation {
         return *this;
     }
 
+    ExpectSegment &with_wscale(std::optional<uint8_t> wscale_) {
+        wscale = wscale_;
+        return *this;
+    }
+
+    ExpectSegment &with_mss(std::optional<uint16_t> mss_) {
+        mss = mss_;
+        return *this;
+    }
+
+    ExpectSegment &with_timestamps(std::optional<TCPHeader::Timestamps> timestamps_) {
+        timestamps = timestamps_;
+        return *this;
+    }
+
+    ExpectSegment &with_sack_permitted(bool sack_permitted_) {
+        sack_permitted = sack_permitted_;
+        return *this;
+    }
+
+    //! expect exactly these SACK blocks, in this order (none if empty)
+    ExpectSegment &with_sack(std::vector<TCPHeader::SackBlock> sack_) {
+        sack = std::move(sack_);
+        return *this;
+    }
+
     ExpectSegment &with_payload_size(size_t payload_size_) {
         payload_size = payload_size_;
         return *this;
@@ -202,6 +253,39 @@ struct ExpectSegment : public TCPExpectation {
         if (win.has_value()) {
             o << "win=" << win.value() << ",";
         }
+        if (ece.has_value()) {
+            o << "ece=" << ece.value() << ",";
+        }
+        if (cwr.has_value()) {
+            o << "cwr=" << cwr.value() << ",";
+        }
+        if (ecn.has_value()) {
+            o << "ecn=" << int(ecn.value()) << ",";
+        }
+        if (wscale.has_value()) {
+            o << "wscale=" << (wscale.value().has_value() ? std::to_string(wscale.value().value()) : "none") << ",";
+        }
+        if (mss.has_value()) {
+            o << "mss=" << (mss.value().has_value() ? std::to_string(mss.value().value()) : "none") << ",";
+        }
+        if (timestamps.has_value()) {
+            o << "ts=";
+            if (timestamps.value().has_value()) {
+                o << timestamps.value()->tsval << "/" << timestamps.value()->tsecr << ",";
+            } else {
+                o << "none,";
+            }
+        }
+        if (sack_permitted.has_value()) {
+            o << "sackOK=" << sack_permitted.value() << ",";
+        }
+        if (sack.has_value()) {
+            o << "sack=";
+            for (const auto &block : sack.value()) {
+                o << block.left << "-" << block.right << " ";
+            }
+            o << ",";
+        }
         if (seqno.has_value()) {
             o << "seqno=" << seqno.value() << ",";
         }
@@ -227,6 +311,7 @@ struct ExpectSegment : public TCPExpectation {
         if (ParseResult::NoError != seg.parse(harness._flt.read())) {
             throw SegmentExpectationViolation::violated_verb("was parsable");
         }
+        seg.ecn() = harness._flt.last_read_ecn();
         if (ack.has_value() and seg.header().ack != ack.value()) {
             throw SegmentExpectationViolation::violated_field("ack", ack.value(), seg.header().ack);
         }
@@ -239,6 +324,15 @@ struct ExpectSegment : public TCPExpectation {
         if (fin.has_value() and seg.header().fin != fin.value()) {
             throw SegmentExpectationViolation::violated_field("fin", fin.value(), seg.header().fin);
         }
+        if (ece.has_value() and seg.header().ece != ece.value()) {
+            throw SegmentExpectationViolation::violated_field("ece", ece.value(), seg.header().ece);
+        }
+        if (cwr.has_value() and seg.header().cwr != cwr.value()) {
+            throw SegmentExpectationViolation::violated_field("cwr", cwr.value(), seg.header().cwr);
+        }
+        if (ecn.has_value() and seg.ecn() != ecn.value()) {
+            throw SegmentExpectationViolation::violated_field("ecn", int(ecn.value()), int(seg.ecn()));
+        }
         if (seqno.has_value() and seg.header().seqno != seqno.value()) {
             throw SegmentExpectationViolation::violated_field("seqno", seqno.value(), seg.header().seqno);
         }
@@ -248,6 +342,44 @@ struct ExpectSegment : public TCPExpectation {
         if (win.has_value() and seg.header().win != win.value()) {
             throw SegmentExpectationViolation::violated_field("win", win.value(), seg.header().win);
         }
+        if (wscale.has_value() and seg.header().wscale != wscale.value()) {
+            // -1 stands for "no Window Scale option"
+            throw SegmentExpectationViolation::violated_field("wscale",
+                                                              wscale.value() ? int(*wscale.value()) : -1,
+                                                              seg.header().wscale ? int(*seg.header().wscale) : -1);
+        }
+        if (mss.has_value() and seg.header().mss != mss.value()) {
+            // -1 stands for "no MSS option"
+            throw SegmentExpectationViolation::violated_field(
+                "mss", mss.value() ? int(*mss.value()) : -1, seg.header().mss ? int(*seg.header().mss) : -1);
+        }
+        if (timestamps.has_value() and not(seg.header().timestamps == timestamps.value())) {
+            const auto describe = [](const std::optional<TCPHeader::Timestamps> &ts) {
+                return ts.has_value() ? std::to_string(ts->tsval) + "/" + std::to_string(ts->tsecr) : "none";
+            };
+            throw SegmentExpectationViolation::violated_field(
+                "timestamps", describe(timestamps.value()), describe(seg.header().timestamps));
+        }
+        if (sack_permitted.has_value() and seg.header().sack_permitted != sack_permitted.value()) {
+            throw SegmentExpectationViolation::violated_field(
+                "sack_permitted", sack_permitted.value(), seg.header().sack_permitted);
+        }
+        if (sack.has_value()) {
+            if (seg.header().sack_count != sack.value().size()) {
+                throw SegmentExpectationViolation::violated_field(
+                    "sack_count", sack.value().size(), size_t{seg.header().sack_count});
+            }
+            for (size_t i = 0; i < sack.value().size(); ++i) {
+                const auto &expected = sack.value()[i];
+                const auto &actual = seg.header().sack_blocks[i];
+                if (not(actual == expected)) {
+                    throw SegmentExpectationViolation::violated_field(
+                        "sack block " + std::to_string(i),
+                        std::to_string(expected.left.raw_value()) + "-" + std::to_string(expected.right.raw_value()),
+                        std::to_string(actual.left.raw_value()) + "-" + std::to_string(actual.right.raw_value()));
+                }
+            }
+        }
         if (payload_size.has_value() and seg.payload().size() != payload_size.value()) {
             throw SegmentExpectationViolation::violated_field(
                 "payload_size", payload_size.value(), seg.payload().size());
@@ -387,9 +519,17 @@ struct SendSegment : public TCPAction {
     bool rst{false};
     bool syn{false};
     bool fin{false};
+    bool ece{false};
+    bool cwr{false};
+    IPv4Header::ECN ecn{IPv4Header::ECN::NotECT};
     WrappingInt32 seqno{0};
     WrappingInt32 ackno{0};
     uint16_t win{0};
+    std::optional<uint8_t> wscale{};
+    std::optional<uint16_t> mss{};
+    std::optional<TCPHeader::Timestamps> timestamps{};
+    bool sack_permitted{false};
+    std::vector<TCPHeader::SackBlock> sack{};
     size_t payload_size{0};
     std::string data{};
 
@@ -400,9 +540,17 @@ struct SendSegment : public TCPAction {
         rst = seg.header().rst;
         syn = seg.header().syn;
         fin = seg.header().fin;
+        ece = seg.header().ece;
+        cwr = seg.header().cwr;
+        ecn = seg.ecn();
         seqno = seg.header().seqno;
         ackno = seg.header().ackno;
         win = seg.header().win;
+        wscale = seg.header().wscale;
+        mss = seg.header().mss;
+        timestamps = seg.header().timestamps;
+        sack_permitted = seg.header().sack_permitted;
+        sack.assign(seg.header().sack_blocks.begin(), seg.header().sack_blocks.begin() + seg.header().sack_count);
         data = seg.payload();
     }
 
@@ -426,6 +574,22 @@ struct SendSegment : public TCPAction {
         return *this;
     }
 
+    SendSegment &with_ece(bool ece_) {
+        ece = ece_;
+        return *this;
+    }
+
+    SendSegment &with_cwr(bool cwr_) {
+        cwr = cwr_;
+        return *this;
+    }
+
+    //! the ECN codepoint the segment arrives with in the IP header
+    SendSegment &with_ecn(IPv4Header::ECN ecn_) {
+        ecn = ecn_;
+        return *this;
+    }
+
     SendSegment &with_seqno(WrappingInt32 seqno_) {
         seqno = seqno_;
         return *this;
@@ -445,6 +609,31 @@ struct SendSegment : public TCPAction {
         return *this;
     }
 
+    SendSegment &with_wscale(uint8_t wscale_) {
+        wscale = wscale_;
+        return *this;
+    }
+
+    SendSegment &with_mss(uint16_t mss_) {
+        mss = mss_;
+        return *this;
+    }
+
+    SendSegment &with_timestamps(uint32_t tsval, uint32_t tsecr) {
+        timestamps = TCPHeader::Timestamps{tsval, tsecr};
+        return *this;
+    }
+
+    SendSegment &with_sack_permitted(bool sack_permitted_) {
+        sack_permitted = sack_permitted_;
+        return *this;
+    }
+
+    SendSegment &with_sack(std::vector<TCPHeader::SackBlock> sack_) {
+        sack = std::move(sack_);
+        return *this;
+    }
+
     SendSegment &with_payload_size(size_t payload_size_) {
         payload_size = payload_size_;
         return *this;
@@ -463,9 +652,18 @@ struct SendSegment : public TCPAction {
         data_hdr.rst = rst;
         data_hdr.syn = syn;
         data_hdr.fin = fin;
+        data_hdr.ece = ece;
+        data_hdr.cwr = cwr;
+        data_seg.ecn() = ecn;
         data_hdr.ackno = ackno;
         data_hdr.seqno = seqno;
         data_hdr.win = win;
+        data_hdr.wscale = wscale;
+        data_hdr.mss = mss;
+        data_hdr.timestamps = timestamps;
+        data_hdr.sack_permitted = sack_permitted;
+        data_hdr.sack_count = sack.size();
+        std::copy(sack.begin(), sack.end(), data_hdr.sack_blocks.begin());
         return data_seg;
     }
 
@@ -559,6 +757,14 @@ struct Listen : public TCPAction {
     void execute(TCPTestHarness &) const {}
 };
 
+struct SetQuickAck : public TCPAction {
+    bool quick_ack;
+
+    SetQuickAck(bool quick_ack_) : quick_ack(quick_ack_) {}
+    std::string description() const { return std::string("quick ACK ") + (quick_ack ? "on" : "off"); }
+    void execute(TCPTestHarness &harness) const { harness._fsm.set_quick_ack(quick_ack); }
+};
+
 struct Close : public TCPAction {
     std::string description() const { return "close"; }
     void execute(TCPTestHarness &harness) const { harness._fsm.end_input_stream(); }
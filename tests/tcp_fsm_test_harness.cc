@@ -65,9 +65,20 @@ void TestFdAdapter::config_segment(TCPSegment &seg) {
 }
 
 //! \param[in] seg is the TCPSegment to write
-void TestFdAdapter::write(TCPSegment &seg) {
+void TestFdAdapter::write(TCPSegment &&seg) {
     config_segment(seg);
     TestFD::write(seg.serialize());
+    _ecn_written.push(seg.ecn());
+}
+
+//! \details The codepoint belongs to the IP header, so it travels beside the serialized segment.
+string TestFdAdapter::read() {
+    if (_ecn_written.empty()) {
+        throw runtime_error("TestFdAdapter read a segment it never wrote.");
+    }
+    _last_read_ecn = _ecn_written.front();
+    _ecn_written.pop();
+    return TestFD::read();
 }
 
 //! \param[in] seqno is the sequence number of the segment
@@ -145,7 +156,7 @@ void TCPTestHarness::execute(const TCPTestStep &step, std::string note) {
     try {
         step.execute(*this);
         while (not _fsm.segments_out().empty()) {
-            _flt.write(_fsm.segments_out().front());
+            _flt.write(move(_fsm.segments_out().front()));
             _fsm.segments_out().pop();
         }
         _steps_executed.emplace_back(step.to_string());
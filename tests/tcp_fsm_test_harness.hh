@@ -12,6 +12,8 @@
 #include <cstdint>
 #include <exception>
 #include <optional>
+#include <queue>
+#include <string>
 #include <vector>
 
 //! \brief A wrapper class for a SOCK_SEQPACKET [Unix-domain socket](\ref man7::unix), for use by TCPTestHarness
@@ -49,8 +51,15 @@ class TestFD : public FileDescriptor {
 
 //! An FdAdapterBase that writes to a TestFD. Does not (need to) support reading.
 class TestFdAdapter : public FdAdapterBase, public TestFD {
+  private:
+    std::queue<IPv4Header::ECN> _ecn_written{};  //!< ECN codepoints of the segments written but not yet read
+    IPv4Header::ECN _last_read_ecn{};             //!< ECN codepoint of the segment last read
+
   public:
-    void write(TCPSegment &seg);  //!< Write a TCPSegment to the underlying TestFD
+    void write(TCPSegment &&seg);  //!< Write a TCPSegment to the underlying TestFD, consuming it
+
+    std::string read();  //!< Read a segment from the underlying TestFD, noting its ECN codepoint
+    IPv4Header::ECN last_read_ecn() const { return _last_read_ecn; }  //!< ECN codepoint of the last segment read
 
     void config_segment(TCPSegment &seg);  //!< Copy information from FdAdapterConfig into a TCPSegment
 };
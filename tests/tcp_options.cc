@@ -0,0 +1,98 @@
+#include "parser.hh"
+#include "tcp_header.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+constexpr unsigned NREPS = 32;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // options must survive serialize -> parse, with doff following the options
+        for (unsigned i = 0; i < NREPS; ++i) {
+            TCPHeader opt_hdr{};
+            opt_hdr.seqno = WrappingInt32{static_cast<uint32_t>(rd())};
+            opt_hdr.syn = rd() % 2;
+            if (rd() % 2) {
+                opt_hdr.mss = static_cast<uint16_t>(rd());
+            }
+            if (rd() % 2) {
+                opt_hdr.wscale = rd() % (TCPHeader::MAX_WINDOW_SHIFT + 1);
+            }
+            opt_hdr.sack_permitted = rd() % 2;
+            if (rd() % 2) {
+                opt_hdr.timestamps = TCPHeader::Timestamps{static_cast<uint32_t>(rd()), static_cast<uint32_t>(rd())};
+            }
+            while (opt_hdr.sack_count < TCPHeader::MAX_SACK_BLOCKS &&
+                   opt_hdr.options_length() + (opt_hdr.sack_count ? 8 : 12) <= TCPHeader::MAX_OPTIONS_LENGTH &&
+                   rd() % 2) {
+                const uint32_t left = rd();
+                opt_hdr.sack_blocks[opt_hdr.sack_count++] = {WrappingInt32{left},
+                                                             WrappingInt32{left + static_cast<uint32_t>(rd() % 65536)}};
+            }
+            opt_hdr.doff = opt_hdr.length() / 4;
+
+            TCPHeader opt_hdr_2{};
+            {
+                NetParser p{opt_hdr.serialize()};
+                if (const auto res = opt_hdr_2.parse(p); res != ParseResult::NoError) {
+                    throw runtime_error("header with options parse failed: " + as_string(res));
+                }
+            }
+            if (!(opt_hdr == opt_hdr_2) || opt_hdr.doff != opt_hdr_2.doff) {
+                throw runtime_error("options did not round-trip:\n" + opt_hdr.to_string() + "became\n" +
+                                    opt_hdr_2.to_string());
+            }
+        }
+
+        // a header claiming more options than MAX_OPTIONS_LENGTH cannot be serialized
+        {
+            TCPHeader big_hdr{};
+            big_hdr.mss = 1460;
+            big_hdr.timestamps = TCPHeader::Timestamps{};
+            big_hdr.sack_count = TCPHeader::MAX_SACK_BLOCKS;
+            bool threw = false;
+            try {
+                big_hdr.serialize();
+            } catch (const runtime_error &) {
+                threw = true;
+            }
+            if (!threw) {
+                throw runtime_error("serialized a header whose options do not fit");
+            }
+        }
+
+        // unknown and malformed options are skipped without failing the parse
+        {
+            string raw = TCPHeader{}.serialize();
+            raw += string{"\x1e\x04\xab\xcd"          // unknown kind 30, length 4
+                          "\x03\x03\x09"              // window scale 9
+                          "\x02\x0a\x05\xb4\x00\x00",  // MSS claiming a length beyond the header
+                          13};
+            raw += string(3, 0);  // pad to 4-byte multiple
+            raw[12] = static_cast<char>((raw.size() / 4) << 4);
+            TCPHeader odd_hdr{};
+            NetParser p{string{raw}};
+            if (const auto res = odd_hdr.parse(p); res != ParseResult::NoError) {
+                throw runtime_error("header with unknown options failed to parse: " + as_string(res));
+            }
+            if (odd_hdr.wscale != 9 || odd_hdr.mss.has_value() || odd_hdr.doff != raw.size() / 4) {
+                throw runtime_error("bad parse of unknown or malformed options");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -4,6 +4,7 @@
 #include "tcp_header.hh"
 #include "util.hh"
 
+#include <algorithm>
 #include <cstdint>
 #include <iomanip>
 #include <iostream>
@@ -31,8 +32,12 @@ inline void show_ethernet_frame(const uint8_t *pkt, const struct pcap_pkthdr &hd
 
 inline bool compare_tcp_headers_nolen(const TCPHeader &h1, const TCPHeader &h2) {
     return h1.sport == h2.sport && h1.dport == h2.dport && h1.seqno == h2.seqno && h1.ackno == h2.ackno &&
-           h1.urg == h2.urg && h1.ack == h2.ack && h1.psh == h2.psh && h1.rst == h2.rst && h1.syn == h2.syn &&
-           h1.fin == h2.fin && h1.win == h2.win && h1.uptr == h2.uptr;
+           h1.cwr == h2.cwr && h1.ece == h2.ece && h1.urg == h2.urg && h1.ack == h2.ack && h1.psh == h2.psh &&
+           h1.rst == h2.rst && h1.syn == h2.syn && h1.fin == h2.fin && h1.win == h2.win && h1.uptr == h2.uptr &&
+           h1.mss == h2.mss && h1.wscale == h2.wscale &&
+           h1.sack_permitted == h2.sack_permitted && h1.sack_count == h2.sack_count &&
+           std::equal(h1.sack_blocks.begin(), h1.sack_blocks.begin() + h1.sack_count, h2.sack_blocks.begin()) &&
+           h1.timestamps == h2.timestamps;
 }
 
 inline bool compare_tcp_headers(const TCPHeader &h1, const TCPHeader &h2) {